@@ -1,40 +1,25 @@
-import os
-import sys
-
 from backports._datetime_fromisoformat import date_fromisoformat, datetime_fromisoformat, time_fromisoformat, FixedOffset
+from backports._datetime_fromisoformat import IncrementalParser
+from backports._datetime_fromisoformat import date_fromisoformat_many, datetime_fromisoformat_many, time_fromisoformat_many
+from backports._datetime_fromisoformat import date_fromisoformat_to_days, datetime_fromisoformat_to_epoch, datetime_fromisoformat_to_epoch_arrow
+from backports._datetime_fromisoformat import datetime_fromisoformat_lines, parse_isoformat_prefix
+from backports._datetime_fromisoformat import IsoformatFields, parse_isoformat_fields
+from backports._datetime_fromisoformat import is_isoformat_date, is_isoformat_datetime, is_isoformat_time
+from backports._datetime_fromisoformat import is_isoformat_date_many, is_isoformat_datetime_many, is_isoformat_time_many
+from backports._datetime_fromisoformat import isoformat_many
+from backports._datetime_fromisoformat import get_timezone_mode, set_timezone_mode
+from backports._datetime_fromisoformat import get_result_cache_info, set_result_cache
+from backports._datetime_fromisoformat import patch_fromisoformat
 
 
-class MonkeyPatch(object):
-    @staticmethod
-    def patch_fromisoformat():
-        import ctypes as c
-
-        def flush_mro_cache():
-            # From https://stackoverflow.com/questions/24497316/set-a-read-only-attribute-in-python/24498525#24498525
-
-            if os.name == "nt":
-                pythonapi = c.PyDLL("python dll", None, sys.dllhandle)
-            elif sys.platform == "cygwin":
-                pythonapi = c.PyDLL("libpython%d.%d.dll" % sys.version_info[:2])
-            else:
-                pythonapi = c.PyDLL(None)
-
-            pythonapi.PyType_Modified(c.py_object(object))
+def get_include():
+    """Return the directory of datetime_fromisoformat_api.h (and its .pxd), for C extensions using the C API."""
+    import os  # Here, so that importing the package doesn't import os
 
-        _get_dict = c.pythonapi._PyObject_GetDictPtr
-        _get_dict.restype = c.POINTER(c.py_object)
-        _get_dict.argtypes = [c.py_object]
+    return os.path.dirname(os.path.abspath(__file__))
 
-        from datetime import date, datetime, time
 
-        if sys.version_info.major >= 3 and sys.version_info < (3, 11):
-            d = _get_dict(datetime)[0]
-            d['fromisoformat'] = datetime_fromisoformat
-
-            d = _get_dict(date)[0]
-            d['fromisoformat'] = date_fromisoformat
-
-            d = _get_dict(time)[0]
-            d['fromisoformat'] = time_fromisoformat
-
-            flush_mro_cache()
+class MonkeyPatch(object):
+    @staticmethod
+    def patch_fromisoformat():
+        patch_fromisoformat()
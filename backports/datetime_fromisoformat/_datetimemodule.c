@@ -3,8 +3,6 @@
  * 037e9125527d4a55af566f161c96a61b3c3fd998)
  * It was then refreshed using the Python 3.11 contents present at
  * 27d8dc2c9d3de886a884f79f0621d4586c0e0f7a
- * Finally, the `_PyUnicode_Copy` implementation was copied from
- * c8749b578324ad4089c8d014d9136bc42b065343
  *
  * Since then, I have:
  *   - torn out all the functionality that doesn't matter to
@@ -12,7 +10,9 @@
  *   - switched calls to datetime creation to use the versions found in
  *     `PyDateTimeAPI`
  *   - made minor changes to make it compilable for older versions of Python.
- *     - Including in-lining a copy of _PyUnicode_Copy
+ *   - moved the parsing functions to `parse_isoformat.h`, so that they can
+ *     read str objects of any kind (and bytes-like objects) directly,
+ *     instead of encoding them to UTF-8 first
  *
  * Below is a copy of the Python 3.11 code license
  * (from https://docs.python.org/3/license.html):
@@ -70,6 +70,11 @@
 #include <datetime.h>
 #include "Python.h"
 #include "timezone.h"
+#include "arrow_c_data.h"
+#include "parallel.h"
+
+#define DATETIME_FROMISOFORMAT_IMPL
+#include "datetime_fromisoformat_api.h"
 
 #define PY_VERSION_AT_LEAST_36 \
     ((PY_MAJOR_VERSION == 3 && PY_MINOR_VERSION >= 6) || PY_MAJOR_VERSION > 3)
@@ -307,7 +312,6 @@ iso_to_ymd(const int iso_year, const int iso_week, const int iso_day,
  * Range checkers.
  */
 
-#if !PY_VERSION_AT_LEAST_36
 /* Check that date arguments are in range.  Return 0 if they are.  If they
  * aren't, raise ValueError and return -1.
  */
@@ -357,235 +361,156 @@ check_time_args(int h, int m, int s, int us, int fold)
     }
     return 0;
 }
-#endif
+
+/* Check that a UTC offset (in seconds) is in range.  Return 0 if it is.  If
+ * it isn't, raise ValueError and return -1.
+ */
+static int
+check_utc_offset(int offset)
+{
+    // Not abs(offset), which overflows for INT_MIN from the C API
+    if (offset <= -86400 || offset >= 86400) {
+        PyObject *delta = PyDelta_FromDSU(0, offset, 0);
+        if (delta == NULL) {
+            return -1;
+        }
+        PyErr_Format(PyExc_ValueError, "offset must be a timedelta"
+                        " strictly between -timedelta(hours=24) and"
+                        " timedelta(hours=24),"
+                        " not %R.", delta);
+        Py_DECREF(delta);
+        return -1;
+    }
+    return 0;
+}
 
 /* ---------------------------------------------------------------------------
  * String parsing utilities and helper functions
  */
 
 static unsigned char
-is_digit(const char c) {
+is_digit(const Py_UCS4 c) {
     return ((unsigned int)(c - '0')) < 10;
 }
 
-static const char *
-parse_digits(const char *ptr, int *var, size_t num_digits)
-{
-    size_t i = 0;
-    for (i = 0; i < num_digits; ++i) {
-        unsigned int tmp = (unsigned int)(*(ptr++) - '0');
-        if (tmp > 9) {
-            return NULL;
-        }
-        *var *= 10;
-        *var += (signed int)tmp;
-    }
+/* UTF-8, from bytes-like objects */
+#define ISOFORMAT_CHAR char
+#define ISOFORMAT(name) name##_utf8
+#define ISOFORMAT_UTF8 1
+#include "parse_isoformat.h"
+#undef ISOFORMAT_CHAR
+#undef ISOFORMAT
+#undef ISOFORMAT_UTF8
+
+#define ISOFORMAT_CHAR Py_UCS1
+#define ISOFORMAT(name) name##_ucs1
+#define ISOFORMAT_UTF8 0
+#include "parse_isoformat.h"
+#undef ISOFORMAT_CHAR
+#undef ISOFORMAT
+#undef ISOFORMAT_UTF8
+
+#define ISOFORMAT_CHAR Py_UCS2
+#define ISOFORMAT(name) name##_ucs2
+#define ISOFORMAT_UTF8 0
+#include "parse_isoformat.h"
+#undef ISOFORMAT_CHAR
+#undef ISOFORMAT
+#undef ISOFORMAT_UTF8
+
+#define ISOFORMAT_CHAR Py_UCS4
+#define ISOFORMAT(name) name##_ucs4
+#define ISOFORMAT_UTF8 0
+#include "parse_isoformat.h"
+#undef ISOFORMAT_CHAR
+#undef ISOFORMAT
+#undef ISOFORMAT_UTF8
+
+/* Besides the PyUnicode_*_KIND values, the functions below accept UTF8_KIND
+ * for the (UTF-8 encoded) contents of bytes-like objects.
+ */
+#define UTF8_KIND 8
 
-    return ptr;
-}
+#include "parse_isoformat_sse2.h"
 
 static int
-parse_isoformat_date(const char *dtstr, const size_t len, int *year, int *month, int *day)
+parse_isoformat_date_kind(int kind, const void *data, Py_ssize_t len,
+                          int *year, int *month, int *day)
 {
-    /* Parse the date components of the result of date.isoformat()
-     *
-     *  Return codes:
-     *       0:  Success
-     *      -1:  Failed to parse date component
-     *      -2:  Inconsistent date separator usage
-     *      -3:  Failed to parse ISO week.
-     *      -4:  Failed to parse ISO day.
-     *      -5, -6: Failure in iso_to_ymd
-     */
-    const char *p = dtstr;
-    p = parse_digits(p, year, 4);
-    if (NULL == p) {
-        return -1;
-    }
-
-    const unsigned char uses_separator = (*p == '-');
-    if (uses_separator) {
-        ++p;
-    }
-
-    if(*p == 'W') {
-        // This is an isocalendar-style date string
-        p++;
-        int iso_week = 0;
-        int iso_day = 0;
-
-        p = parse_digits(p, &iso_week, 2);
-        if (NULL == p) {
-            return -3;
-        }
-
-        assert(p > dtstr);
-        if ((size_t)(p - dtstr) < len) {
-            if (uses_separator && *(p++) != '-') {
-                return -2;
-            }
-
-            p = parse_digits(p, &iso_day, 1);
-            if (NULL == p) {
-                return -4;
-            }
-        } else {
-            iso_day = 1;
-        }
-
-        int rv = iso_to_ymd(*year, iso_week, iso_day, year, month, day);
-        if (rv) {
-            return -3 + rv;
-        } else {
-            return 0;
-        }
-    }
-
-    p = parse_digits(p, month, 2);
-    if (NULL == p) {
-        return -1;
-    }
-
-    if (uses_separator && *(p++) != '-') {
-        return -2;
-    }
-    p = parse_digits(p, day, 2);
-    if (p == NULL) {
-        return -1;
+    switch (kind) {
+        case PyUnicode_1BYTE_KIND:
+            return parse_isoformat_date_ucs1(data, len, year, month, day);
+        case PyUnicode_2BYTE_KIND:
+            return parse_isoformat_date_ucs2(data, len, year, month, day);
+        case PyUnicode_4BYTE_KIND:
+            return parse_isoformat_date_ucs4(data, len, year, month, day);
+        default:
+            return parse_isoformat_date_utf8(data, len, year, month, day);
     }
-    return 0;
 }
 
 static int
-parse_hh_mm_ss_ff(const char *tstr, const char *tstr_end, int *hour,
-                  int *minute, int *second, int *microsecond)
+parse_isoformat_time_string_kind(int kind, const void *data, Py_ssize_t len,
+                                 int *hour, int *minute, int *second,
+                                 int *microsecond, int *tzoffset,
+                                 int *tzusec)
 {
-    *hour = *minute = *second = *microsecond = 0;
-    const char *p = tstr;
-    const char *p_end = tstr_end;
-    int *vals[3] = {hour, minute, second};
-    size_t i = 0;
-    // This is initialized to satisfy an erroneous compiler warning.
-    unsigned char has_separator = 1;
-
-    // Parse [HH[:?MM[:?SS]]]
-    for (i = 0; i < 3; ++i) {
-        p = parse_digits(p, vals[i], 2);
-        if (NULL == p) {
-            return -3;
-        }
-
-        char c = *(p++);
-        if (i == 0) {
-            has_separator = (c == ':');
-        }
-
-        if (p >= p_end) {
-            return c != '\0';
-        }
-        else if (has_separator && (c == ':')) {
-            continue;
-        }
-        else if (c == '.' || c == ',') {
-            break;
-        } else if (!has_separator) {
-            --p;
-        } else {
-            return -4;  // Malformed time separator
-        }
-    }
-
-    // Parse fractional components
-    size_t len_remains = p_end - p;
-    size_t to_parse = len_remains;
-    if (len_remains >= 6) {
-        to_parse = 6;
-    }
-
-    p = parse_digits(p, microsecond, to_parse);
-    if (NULL == p) {
-        return -3;
-    }
-
-    static int correction[] = {
-        100000, 10000, 1000, 100, 10
-    };
-
-    if (to_parse < 6) {
-        *microsecond *= correction[to_parse-1];
+    switch (kind) {
+        case PyUnicode_1BYTE_KIND:
+            return parse_isoformat_time_string_ucs1(
+                data, len, hour, minute, second, microsecond, tzoffset,
+                tzusec);
+        case PyUnicode_2BYTE_KIND:
+            return parse_isoformat_time_string_ucs2(
+                data, len, hour, minute, second, microsecond, tzoffset,
+                tzusec);
+        case PyUnicode_4BYTE_KIND:
+            return parse_isoformat_time_string_ucs4(
+                data, len, hour, minute, second, microsecond, tzoffset,
+                tzusec);
+        default:
+            return parse_isoformat_time_string_utf8(
+                data, len, hour, minute, second, microsecond, tzoffset,
+                tzusec);
     }
-
-    while (is_digit(*p)){
-        ++p; // skip truncated digits
-    }
-
-    // Return 1 if it's not the end of the string
-    return *p != '\0';
 }
 
 static int
-parse_isoformat_time(const char *dtstr, size_t dtlen, int *hour, int *minute,
-                     int *second, int *microsecond, int *tzoffset,
-                     int *tzmicrosecond)
-{
-    // Parse the time portion of a datetime.isoformat() string
-    //
-    // Return codes:
-    //      0:  Success (no tzoffset)
-    //      1:  Success (with tzoffset)
-    //     -3:  Failed to parse time component
-    //     -4:  Failed to parse time separator
-    //     -5:  Malformed timezone string
-
-    const char *p = dtstr;
-    const char *p_end = dtstr + dtlen;
-
-    const char *tzinfo_pos = p;
-    do {
-        if (*tzinfo_pos == 'Z' || *tzinfo_pos == '+' || *tzinfo_pos == '-') {
-            break;
-        }
-    } while (++tzinfo_pos < p_end);
-
-    int rv = parse_hh_mm_ss_ff(dtstr, tzinfo_pos, hour, minute, second,
-                               microsecond);
-
-    if (rv < 0) {
-        return rv;
-    }
-    else if (tzinfo_pos == p_end) {
-        // We know that there's no time zone, so if there's stuff at the
-        // end of the string it's an error.
-        if (rv == 1) {
-            return -5;
-        }
-        else {
-            return 0;
+parse_isoformat_datetime_kind(int kind, const void *data, Py_ssize_t len,
+                              int *year, int *month, int *day, int *hour,
+                              int *minute, int *second, int *microsecond,
+                              int *nanosecond, int *tzoffset, int *tzusec)
+{
+#ifdef HAVE_ISOFORMAT_SSE2
+    if (kind == PyUnicode_1BYTE_KIND || kind == UTF8_KIND) {
+        *nanosecond = 0;
+        const int rv = parse_isoformat_datetime_sse2(
+            data, len, year, month, day, hour, minute, second, microsecond,
+            tzoffset, tzusec);
+        if (rv != -1) {
+            return rv;
         }
     }
+#endif
 
-    // Special case UTC / Zulu time.
-    if (*tzinfo_pos == 'Z') {
-        *tzoffset = 0;
-        *tzmicrosecond = 0;
-
-        if (*(tzinfo_pos + 1) != '\0') {
-            return -5;
-        } else {
-            return 1;
-        }
+    switch (kind) {
+        case PyUnicode_1BYTE_KIND:
+            return parse_isoformat_datetime_ucs1(
+                data, len, year, month, day, hour, minute, second,
+                microsecond, nanosecond, tzoffset, tzusec);
+        case PyUnicode_2BYTE_KIND:
+            return parse_isoformat_datetime_ucs2(
+                data, len, year, month, day, hour, minute, second,
+                microsecond, nanosecond, tzoffset, tzusec);
+        case PyUnicode_4BYTE_KIND:
+            return parse_isoformat_datetime_ucs4(
+                data, len, year, month, day, hour, minute, second,
+                microsecond, nanosecond, tzoffset, tzusec);
+        default:
+            return parse_isoformat_datetime_utf8(
+                data, len, year, month, day, hour, minute, second,
+                microsecond, nanosecond, tzoffset, tzusec);
     }
-
-    int tzsign = (*tzinfo_pos == '-') ? -1 : 1;
-    tzinfo_pos++;
-    int tzhour = 0, tzminute = 0, tzsecond = 0;
-    rv = parse_hh_mm_ss_ff(tzinfo_pos, p_end, &tzhour, &tzminute, &tzsecond,
-                           tzmicrosecond);
-
-    *tzoffset = tzsign * ((tzhour * 3600) + (tzminute * 60) + tzsecond);
-    *tzmicrosecond *= tzsign;
-
-    return rv ? -5 : 1;
 }
 
 /* ---------------------------------------------------------------------------
@@ -614,19 +539,11 @@ tzinfo_from_isoformat_results(int rv, int tzoffset, int tz_useconds)
 {
     PyObject *tzinfo;
     if (rv == 1) {
-        if (abs(tzoffset) >= 86400){
-            PyObject *delta;
-
-            delta = PyDelta_FromDSU(0, tzoffset, 0);
-            PyErr_Format(PyExc_ValueError, "offset must be a timedelta"
-                            " strictly between -timedelta(hours=24) and"
-                            " timedelta(hours=24),"
-                            " not %R.", delta);
-            Py_DECREF(delta);
+        if (check_utc_offset(tzoffset) < 0) {
             return NULL;
         }
 
-        tzinfo = new_fixed_offset(tzoffset);
+        tzinfo = new_tzinfo(tzoffset);
     }
     else {
         tzinfo = Py_None;
@@ -636,37 +553,93 @@ tzinfo_from_isoformat_results(int rv, int tzoffset, int tz_useconds)
     return tzinfo;
 }
 
-/* Return the new date from a string as generated by date.isoformat() */
-PyObject *
-date_fromisoformat(PyObject *dtstr)
+/* Return the length of the UTF-8 encoding of the code units in `data`, or -1
+ * if it contains surrogates (and so can't be encoded).
+ *
+ * CPython parses the UTF-8 encoding of the string, so this is needed to
+ * reproduce its (byte) length checks and its rejection of surrogates without
+ * encoding the string.
+ */
+static Py_ssize_t
+_utf8_length(int kind, const void *data, Py_ssize_t len)
 {
-    assert(dtstr != NULL);
-
-    if (!PyUnicode_Check(dtstr)) {
-        PyErr_SetString(PyExc_TypeError,
-                        "fromisoformat: argument must be str");
-        return NULL;
+    Py_ssize_t utf8_len = len;
+    for (Py_ssize_t i = 0; i < len; ++i) {
+        const Py_UCS4 c = PyUnicode_READ(kind, data, i);
+        if (c < 0x80) {
+            continue;
+        }
+        else if (c < 0x800) {
+            utf8_len += 1;
+        }
+        else if (Py_UNICODE_IS_SURROGATE(c)) {
+            return -1;
+        }
+        else if (c < 0x10000) {
+            utf8_len += 2;
+        }
+        else {
+            utf8_len += 3;
+        }
     }
 
-    Py_ssize_t len;
+    return utf8_len;
+}
 
-    const char *dt_ptr = PyUnicode_AsUTF8AndSize(dtstr, &len);
-    if (dt_ptr == NULL) {
-        goto invalid_string_error;
-    }
+/* The results of parsing a string: `rv` is the return code of the parsing
+ * function, and the other fields are its outputs.
+ */
+typedef struct {
+    int rv;
+    int year, month, day;
+    int hour, minute, second, microsecond, nanosecond;
+    int tzoffset, tzusec;
+} isoformat_fields;
 
-    int year = 0, month = 0, day = 0;
+static const isoformat_fields empty_isoformat_fields = {0};
 
-    int rv;
-    if (len == 7 || len == 8 || len == 10) {
-        rv = parse_isoformat_date(dt_ptr, len, &year, &month, &day);
-    }
-    else {
-        rv = -1;
-    }
+static void
+parse_isoformat_date_fields(int kind, const void *data, Py_ssize_t len,
+                            isoformat_fields *f)
+{
+    *f = empty_isoformat_fields;
+    f->rv = parse_isoformat_date_kind(kind, data, len, &f->year, &f->month,
+                                      &f->day);
+}
 
-    if (rv < 0) {
-        goto invalid_string_error;
+static void
+parse_isoformat_time_fields(int kind, const void *data, Py_ssize_t len,
+                            isoformat_fields *f)
+{
+    *f = empty_isoformat_fields;
+    f->rv = parse_isoformat_time_string_kind(
+        kind, data, len, &f->hour, &f->minute, &f->second, &f->microsecond,
+        &f->tzoffset, &f->tzusec);
+}
+
+static void
+parse_isoformat_datetime_fields(int kind, const void *data, Py_ssize_t len,
+                                isoformat_fields *f)
+{
+    *f = empty_isoformat_fields;
+    f->rv = parse_isoformat_datetime_kind(
+        kind, data, len, &f->year, &f->month, &f->day, &f->hour, &f->minute,
+        &f->second, &f->microsecond, &f->nanosecond, &f->tzoffset,
+        &f->tzusec);
+}
+
+/* Return the new date from the results of parsing a string as generated by
+ * date.isoformat(). `dtstr` is the object the string came from, used in the
+ * error message.
+ */
+static PyObject *
+new_date_from_fields(const isoformat_fields *f, PyObject *dtstr)
+{
+    const int year = f->year, month = f->month, day = f->day;
+
+    if (f->rv < 0) {
+        PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", dtstr);
+        return NULL;
     }
 
 #if !PY_VERSION_AT_LEAST_36
@@ -681,48 +654,21 @@ date_fromisoformat(PyObject *dtstr)
 
     return PyDateTimeAPI->Date_FromDate(year, month, day,
                                         PyDateTimeAPI->DateType);
-invalid_string_error:
-    PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", dtstr);
-    return NULL;
 }
 
-PyObject *
-time_fromisoformat(PyObject *tstr)
+static PyObject *
+new_time_from_fields(const isoformat_fields *f, PyObject *tstr)
 {
-    assert(tstr != NULL);
+    const int hour = f->hour, minute = f->minute, second = f->second;
+    const int microsecond = f->microsecond;
 
-    if (!PyUnicode_Check(tstr)) {
-        PyErr_SetString(PyExc_TypeError,
-                        "fromisoformat: argument must be str");
+    if (f->rv < 0) {
+        PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", tstr);
         return NULL;
     }
 
-    Py_ssize_t len;
-    const char *p = PyUnicode_AsUTF8AndSize(tstr, &len);
-
-    if (p == NULL) {
-        goto invalid_string_error;
-    }
-
-    // The spec actually requires that time-only ISO 8601 strings start with
-    // T, but the extended format allows this to be omitted as long as there
-    // is no ambiguity with date strings.
-    if (*p == 'T') {
-        ++p;
-        len -= 1;
-    }
-
-    int hour = 0, minute = 0, second = 0, microsecond = 0;
-    int tzoffset, tzimicrosecond = 0;
-    int rv = parse_isoformat_time(p, len, &hour, &minute, &second,
-                                  &microsecond, &tzoffset, &tzimicrosecond);
-
-    if (rv < 0) {
-        goto invalid_string_error;
-    }
-
     PyObject *tzinfo =
-        tzinfo_from_isoformat_results(rv, tzoffset, tzimicrosecond);
+        tzinfo_from_isoformat_results(f->rv, f->tzoffset, f->tzusec);
 
     if (tzinfo == NULL) {
         return NULL;
@@ -746,306 +692,2620 @@ time_fromisoformat(PyObject *tstr)
 
     Py_DECREF(tzinfo);
     return t;
-
-invalid_string_error:
-    PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", tstr);
-    return NULL;
 }
 
-PyObject *
-_PyUnicode_Copy(PyObject *unicode)
+static PyObject *
+new_datetime_from_fields(const isoformat_fields *f, PyObject *dtstr)
 {
-    Py_ssize_t length;
-    PyObject *copy;
+    const int year = f->year, month = f->month, day = f->day;
+    const int hour = f->hour, minute = f->minute, second = f->second;
+    const int microsecond = f->microsecond;
 
-    if (!PyUnicode_Check(unicode)) {
-        PyErr_BadInternalCall();
+    if (f->rv < 0) {
+        PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", dtstr);
         return NULL;
     }
 
-    length = PyUnicode_GET_LENGTH(unicode);
-    copy = PyUnicode_New(length, PyUnicode_MAX_CHAR_VALUE(unicode));
-    if (!copy)
+    PyObject *tzinfo =
+        tzinfo_from_isoformat_results(f->rv, f->tzoffset, f->tzusec);
+    if (tzinfo == NULL) {
         return NULL;
-    assert(PyUnicode_KIND(copy) == PyUnicode_KIND(unicode));
-
-    memcpy(PyUnicode_DATA(copy), PyUnicode_DATA(unicode),
-           length * PyUnicode_KIND(unicode));
-    assert(_PyUnicode_CheckConsistency(copy, 1));
-    return copy;
-}
+    }
 
-static PyObject *
-_sanitize_isoformat_str(PyObject *dtstr)
-{
-    Py_ssize_t len = PyUnicode_GetLength(dtstr);
-    if (len < 7) {  // All valid ISO 8601 strings are at least 7 characters long
+#if !PY_VERSION_AT_LEAST_36
+    /* Python 3.6+ does this validation as part of datetime's C API
+     * constructor. See
+     * https://github.com/python/cpython/commit/b67f0967386a9c9041166d2bbe0a421bd81e10bc
+     */
+    if (check_date_args(year, month, day) < 0) {
+        return NULL;
+    }
+    if (check_time_args(hour, minute, second, microsecond, 0) < 0) {
+        return NULL;
+    }
+    if (check_tzinfo_subclass(tzinfo) < 0) {
         return NULL;
     }
+#endif
+
+    PyObject *dt = PyDateTimeAPI->DateTime_FromDateAndTime(
+        year, month, day, hour, minute, second, microsecond, tzinfo,
+        PyDateTimeAPI->DateTimeType);
 
-    // `fromisoformat` allows surrogate characters in exactly one position,
-    // the separator; to allow datetime_fromisoformat to make the simplifying
-    // assumption that all valid strings can be encoded in UTF-8, this function
-    // replaces any surrogate character separators with `T`.
-    //
-    // The result of this, if not NULL, returns a new reference
-    const void* const unicode_data = PyUnicode_DATA(dtstr);
-    const int kind = PyUnicode_KIND(dtstr);
+    Py_DECREF(tzinfo);
+    return dt;
+}
 
+/* Return the position of the surrogate character that `fromisoformat` allows
+ * as the separator, or 0 if there is none.
+ */
+static Py_ssize_t
+_find_surrogate_separator(int kind, const void *data, Py_ssize_t len)
+{
     // Depending on the format of the string, the separator can only ever be
-    // in positions 7, 8 or 10. We'll check each of these for a surrogate and
-    // if we find one, replace it with `T`. If there is more than one surrogate,
-    // we don't have to bother sanitizing it, because the function will later
-    // fail when we try to encode the string as ASCII.
-    static const size_t potential_separators[3] = {7, 8, 10};
-    size_t surrogate_separator = 0;
-    for(size_t idx = 0;
+    // in positions 7, 8 or 10. Like CPython, we'll check each of these for a
+    // surrogate and treat the first one we find as a `T`. Any other surrogate
+    // makes the string invalid.
+    static const Py_ssize_t potential_separators[3] = {7, 8, 10};
+    for (size_t idx = 0;
          idx < sizeof(potential_separators) / sizeof(*potential_separators);
          ++idx) {
-        size_t pos = potential_separators[idx];
-        if (pos > (size_t)len) {
+        const Py_ssize_t pos = potential_separators[idx];
+        if (pos >= len) {
             break;
         }
 
-        if(Py_UNICODE_IS_SURROGATE(PyUnicode_READ(kind, unicode_data, pos))) {
-            surrogate_separator = pos;
-            break;
+        if (Py_UNICODE_IS_SURROGATE(PyUnicode_READ(kind, data, pos))) {
+            return pos;
         }
     }
 
-    if (surrogate_separator == 0) {
-        Py_INCREF(dtstr);
-        return dtstr;
-    }
+    return 0;
+}
 
-    PyObject *str_out = _PyUnicode_Copy(dtstr);
-    if (str_out == NULL) {
-        return NULL;
-    }
+/* Return 1 if the date is in the range the date type accepts, else 0.
+ * Unlike check_date_args, this doesn't raise.
+ */
+static int
+is_valid_date(int year, int month, int day)
+{
+    return year >= MINYEAR && year <= MAXYEAR && month >= 1 &&
+           month <= 12 && day >= 1 && day <= days_in_month(year, month);
+}
 
-    if (PyUnicode_WriteChar(str_out, surrogate_separator, (Py_UCS4)'T')) {
-        Py_DECREF(str_out);
-        return NULL;
-    }
+/* Return 1 if the time is in the range the time type accepts, else 0.
+ * Unlike check_time_args, this doesn't raise.
+ */
+static int
+is_valid_time(int hour, int minute, int second, int microsecond)
+{
+    return hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59 &&
+           second >= 0 && second <= 59 && microsecond >= 0 &&
+           microsecond <= 999999;
+}
 
-    return str_out;
+/* Return 1 if the *_from_fields function would return an object for these
+ * results of parsing a string, else 0. Unlike them, these don't raise.
+ */
+static int
+is_valid_date_fields(const isoformat_fields *f)
+{
+    return f->rv >= 0 && is_valid_date(f->year, f->month, f->day);
 }
 
+static int
+is_valid_time_fields(const isoformat_fields *f)
+{
+    return f->rv >= 0 &&
+           is_valid_time(f->hour, f->minute, f->second, f->microsecond) &&
+           (f->rv == 0 || abs(f->tzoffset) < 86400);
+}
 
-static Py_ssize_t
-_find_isoformat_datetime_separator(const char *dtstr, Py_ssize_t len) {
-    // The valid date formats can all be distinguished by characters 4 and 5
-    // and further narrowed down by character
-    // which tells us where to look for the separator character.
-    // Format    |  As-rendered |   Position
-    // ---------------------------------------
-    // %Y-%m-%d  |  YYYY-MM-DD  |    10
-    // %Y%m%d    |  YYYYMMDD    |     8
-    // %Y-W%V    |  YYYY-Www    |     8
-    // %YW%V     |  YYYYWww     |     7
-    // %Y-W%V-%u |  YYYY-Www-d  |    10
-    // %YW%V%u   |  YYYYWwwd    |     8
-    // %Y-%j     |  YYYY-DDD    |     8
-    // %Y%j      |  YYYYDDD     |     7
-    //
-    // Note that because we allow *any* character for the separator, in the
-    // case where character 4 is W, it's not straightforward to determine where
-    // the separator is — in the case of YYYY-Www-d, you have actual ambiguity,
-    // e.g. 2020-W01-0000 could be YYYY-Www-D0HH or YYYY-Www-HHMM, when the
-    // separator character is a number in the former case or a hyphen in the
-    // latter case.
-    //
-    // The case of YYYYWww can be distinguished from YYYYWwwd by tracking ahead
-    // to either the end of the string or the first non-numeric character —
-    // since the time components all come in pairs YYYYWww#HH can be
-    // distinguished from YYYYWwwd#HH by the fact that there will always be an
-    // odd number of digits before the first non-digit character in the former
-    // case.
-    static const char date_separator = '-';
-    static const char week_indicator = 'W';
-
-    if (len == 7) {
-        return 7;
-    }
-
-    if (dtstr[4] == date_separator) {
-        // YYYY-???
-
-        if (dtstr[5] == week_indicator) {
-            // YYYY-W??
-
-            if (len < 8) {
-                return -1;
-            }
+static int
+is_valid_datetime_fields(const isoformat_fields *f)
+{
+    return is_valid_date_fields(f) && is_valid_time_fields(f);
+}
 
-            if (len > 8 && dtstr[8] == date_separator) {
-                // YYYY-Www-D (10) or YYYY-Www-HH (8)
-                if (len == 9) { return -1; }
-                if (len > 10 && is_digit(dtstr[10])) {
-                    // This is as far as we'll try to go to resolve the
-                    // ambiguity for the moment — if we have YYYY-Www-##, the
-                    // separator is either a hyphen at 8 or a number at 10.
-                    //
-                    // We'll assume it's a hyphen at 8 because it's way more
-                    // likely that someone will use a hyphen as a separator
-                    // than a number, but at this point it's really best effort
-                    // because this is an extension of the spec anyway.
-                    return 8;
-                }
+/* `len` code units of `kind` (one of the PyUnicode_*_KIND values or
+ * UTF8_KIND) at `data`: a string that can be parsed without the GIL. In
+ * the bulk functions, `kind` is SLICE_SERIAL for items that must be handled
+ * with the GIL held instead (bytes-like objects other than bytes, strings
+ * with a surrogate separator and anything that raises), and SLICE_NONE for
+ * None.
+ */
+#define SLICE_SERIAL 0
+#define SLICE_NONE (-1)
 
-                return 10;
-            } else {
-                // YYYY-Www (8)
-                return 8;
-            }
-        } else {
-            // YYYY-MM-DD (10)
-            return 10;
-        }
-    } else {
-        // YYYY???
-        if (dtstr[4] == week_indicator) {
-            // YYYYWww (7) or YYYYWwwd (8)
-            size_t idx = 7;
-            for (; idx < (size_t)len; ++idx) {
-                // Keep going until we run out of digits.
-                if (!is_digit(dtstr[idx])) {
-                    break;
-                }
-            }
+typedef struct {
+    int kind;
+    const void *data;
+    Py_ssize_t len;
+} isoformat_slice;
 
-            if (idx < 9) {
-                return idx;
-            }
+/* Fill `slice` from `obj`, which the caller keeps alive. ASCII strings are
+ * given as UTF-8, which is the same and takes the fastest path.
+ */
+static void
+get_isoformat_slice(PyObject *obj, isoformat_slice *slice)
+{
+    slice->kind = SLICE_SERIAL;
+    slice->data = NULL;
+    slice->len = 0;
 
-            if (idx % 2 == 0) {
-                // If the index of the last number is even, it's YYYYWww
-                return 7;
-            } else {
-                return 8;
-            }
-        } else {
-            // YYYYMMDD (8)
-            return 8;
+    if (obj == Py_None) {
+        slice->kind = SLICE_NONE;
+    }
+    else if (PyBytes_CheckExact(obj)) {
+        slice->kind = UTF8_KIND;
+        slice->data = PyBytes_AS_STRING(obj);
+        slice->len = PyBytes_GET_SIZE(obj);
+    }
+    else if (PyUnicode_Check(obj)) {
+        if (PyUnicode_READY(obj) < 0) {
+            // Raised again when the item is handled with the GIL
+            PyErr_Clear();
+            return;
+        }
+
+        const int kind = PyUnicode_KIND(obj);
+        const void *data = PyUnicode_DATA(obj);
+        const Py_ssize_t len = PyUnicode_GET_LENGTH(obj);
+
+        if (kind != PyUnicode_1BYTE_KIND &&
+            _find_surrogate_separator(kind, data, len)) {
+            return;
         }
+        slice->kind = PyUnicode_IS_ASCII(obj) ? UTF8_KIND : kind;
+        slice->data = data;
+        slice->len = len;
     }
 }
 
-PyObject *
-datetime_fromisoformat(PyObject *dtstr)
+/* Parse a slice as date_fromisoformat_any would, without the GIL */
+static void
+parse_date_slice(const isoformat_slice *slice, isoformat_fields *f)
 {
-    assert(dtstr != NULL);
+    const Py_ssize_t utf8_len =
+        slice->kind == UTF8_KIND
+            ? slice->len
+            : _utf8_length(slice->kind, slice->data, slice->len);
 
-    if (!PyUnicode_Check(dtstr)) {
-        PyErr_SetString(PyExc_TypeError,
-                        "fromisoformat: argument must be str");
-        return NULL;
+    if (utf8_len == 7 || utf8_len == 8 || utf8_len == 10) {
+        parse_isoformat_date_fields(slice->kind, slice->data, slice->len, f);
+    }
+    else {
+        *f = empty_isoformat_fields;
+        f->rv = -1;
     }
+}
 
-    // We only need to sanitize this string if the separator is a surrogate
-    // character. In the situation where the separator location is ambiguous,
-    // we don't have to sanitize it anything because that can only happen when
-    // the separator is either '-' or a number. This should mostly be a noop
-    // but it makes the reference counting easier if we still sanitize.
-    PyObject *dtstr_clean = _sanitize_isoformat_str(dtstr);
-    if (dtstr_clean == NULL) {
-        goto invalid_string_error;
+/* Parse a slice as time_fromisoformat_any would, without the GIL */
+static void
+parse_time_slice(const isoformat_slice *slice, isoformat_fields *f)
+{
+    if (slice->kind != UTF8_KIND && slice->kind != PyUnicode_1BYTE_KIND &&
+        _utf8_length(slice->kind, slice->data, slice->len) < 0) {
+        *f = empty_isoformat_fields;
+        f->rv = -1;
+        return;
     }
 
-    Py_ssize_t len;
-    const char *dt_ptr = PyUnicode_AsUTF8AndSize(dtstr_clean, &len);
+    parse_isoformat_time_fields(slice->kind, slice->data, slice->len, f);
+}
 
-    if (dt_ptr == NULL) {
-        if (PyErr_ExceptionMatches(PyExc_UnicodeEncodeError)) {
-            // Encoding errors are invalid string errors at this point
-            goto invalid_string_error;
-        }
-        else {
-            goto error;
-        }
+/* Parse a slice as datetime_fromisoformat_any would, without the GIL */
+static void
+parse_datetime_slice(const isoformat_slice *slice, isoformat_fields *f)
+{
+    if (slice->kind != UTF8_KIND && slice->kind != PyUnicode_1BYTE_KIND &&
+        _utf8_length(slice->kind, slice->data, slice->len) < 0) {
+        *f = empty_isoformat_fields;
+        f->rv = -1;
+        return;
     }
 
-    const Py_ssize_t separator_location = _find_isoformat_datetime_separator(
-            dt_ptr, len);
+    parse_isoformat_datetime_fields(slice->kind, slice->data, slice->len, f);
+}
 
+/* An opt-in, bounded cache of the dates (and optionally datetimes) parsed
+ * from ASCII strings, keyed on their exact code units, so that strings
+ * repeated many times share one immutable result. Each key can be in one of
+ * a pair of adjacent slots, and a new entry replaces the oldest of the two.
+ */
+#define RESULT_CACHE_KEY_MAX 32
 
-    const char *p = dt_ptr;
+enum {
+    RESULT_CACHE_NONE = 0,
+    RESULT_CACHE_DATE,
+    RESULT_CACHE_DATETIME,
+};
 
-    int year = 0, month = 0, day = 0;
-    int hour = 0, minute = 0, second = 0, microsecond = 0;
-    int tzoffset = 0, tzusec = 0;
+typedef struct {
+    // The cached result, or NULL if the slot is empty
+    PyObject *value;
+    int type;
+    Py_ssize_t len;
+    char key[RESULT_CACHE_KEY_MAX];
+} result_cache_entry;
+
+static struct {
+    result_cache_entry *entries;
+    // The number of slots, 0 if the cache is disabled
+    Py_ssize_t size;
+    Py_ssize_t count;
+    int datetimes;
+    unsigned long long hits, misses;
+} result_cache;
+
+/* Return the first slot of the pair for a slice parsed as `type`, or NULL
+ * if its result isn't cached.
+ */
+static result_cache_entry *
+result_cache_slot(int type, const isoformat_slice *slice)
+{
+    if (result_cache.size == 0 || type == RESULT_CACHE_NONE ||
+        (type == RESULT_CACHE_DATETIME && !result_cache.datetimes) ||
+        slice->kind != UTF8_KIND || slice->len > RESULT_CACHE_KEY_MAX) {
+        return NULL;
+    }
 
-    // date runs up to separator_location
-    int rv = parse_isoformat_date(p, separator_location, &year, &month, &day);
+    // Mix the key 8 bytes at a time, then map the high bits of the hash to
+    // a pair with a multiplication instead of a division.
+    const unsigned char *data = slice->data;
+    const uint64_t k = 0x9e3779b97f4a7c15u;
+    uint64_t hash = ((uint64_t)type << 8 | (uint64_t)slice->len) * k;
+    Py_ssize_t i = 0;
+    for (; i + 8 <= slice->len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * k;
+    }
+    uint64_t word = 0;
+    for (; i < slice->len; ++i) {
+        word = word << 8 | data[i];
+    }
+    hash = (hash ^ word) * k;
 
-    if (!rv && len > separator_location) {
-        // In UTF-8, the length of multi-byte characters is encoded in the MSB
-        p += separator_location;
-        if ((p[0] & 0x80) == 0) {
-            p += 1;
-        }
-        else {
-            switch (p[0] & 0xf0) {
-                case 0xe0:
-                    p += 3;
-                    break;
-                case 0xf0:
-                    p += 4;
-                    break;
-                default:
-                    p += 2;
+    const uint64_t pairs = (uint64_t)(result_cache.size + 1) / 2;
+    const uint64_t pair = ((hash >> 32) * pairs) >> 32;
+    return &result_cache.entries[pair * 2];
+}
+
+static int
+result_cache_matches(const result_cache_entry *entry, int type,
+                     const isoformat_slice *slice)
+{
+    return entry->value != NULL && entry->type == type &&
+           entry->len == slice->len &&
+           memcmp(entry->key, slice->data, slice->len) == 0;
+}
+
+/* Return the second slot of the pair starting at `entry`, or NULL if the
+ * last pair only has one.
+ */
+static result_cache_entry *
+result_cache_partner(result_cache_entry *entry)
+{
+    return entry + 1 < result_cache.entries + result_cache.size ? entry + 1
+                                                                 : NULL;
+}
+
+/* Return a new reference to the cached result in the pair starting at
+ * `entry` for `slice`, or NULL (without an exception set) if it isn't
+ * there.
+ */
+static PyObject *
+result_cache_lookup(result_cache_entry *entry, int type,
+                    const isoformat_slice *slice)
+{
+    result_cache_entry *partner = result_cache_partner(entry);
+    if (!result_cache_matches(entry, type, slice)) {
+        entry = partner;
+    }
+    if (entry != NULL && result_cache_matches(entry, type, slice)) {
+        ++result_cache.hits;
+        Py_INCREF(entry->value);
+        return entry->value;
+    }
+
+    ++result_cache.misses;
+    return NULL;
+}
+
+static void
+result_cache_store(result_cache_entry *entry, int type,
+                   const isoformat_slice *slice, PyObject *value)
+{
+    // The newest entry of a full pair is its first slot
+    result_cache_entry *partner = result_cache_partner(entry);
+    PyObject *old = NULL;
+    if (partner != NULL && entry->value != NULL) {
+        old = partner->value;
+        *partner = *entry;
+    }
+    else {
+        old = entry->value;
+    }
+    if (old == NULL) {
+        ++result_cache.count;
+    }
+
+    Py_INCREF(value);
+    entry->value = value;
+    entry->type = type;
+    entry->len = slice->len;
+    memcpy(entry->key, slice->data, slice->len);
+    Py_XDECREF(old);
+}
+
+void
+clear_result_cache(void)
+{
+    for (Py_ssize_t i = 0; i < result_cache.size; ++i) {
+        Py_CLEAR(result_cache.entries[i].value);
+    }
+    result_cache.count = 0;
+}
+
+PyObject *
+set_result_cache(Py_ssize_t maxsize, int datetimes)
+{
+    // Slots are chosen with 32-bit arithmetic
+    if (maxsize < 0 || maxsize > INT32_MAX) {
+        PyErr_Format(PyExc_ValueError,
+                     "maxsize must be between 0 and %d, not %zd", INT32_MAX,
+                     maxsize);
+        return NULL;
+    }
+
+    result_cache_entry *entries = NULL;
+    if (maxsize > 0) {
+        entries = PyMem_New(result_cache_entry, maxsize);
+        if (entries == NULL) {
+            return PyErr_NoMemory();
+        }
+        memset(entries, 0, sizeof(*entries) * (size_t)maxsize);
+    }
+
+    clear_result_cache();
+    PyMem_Free(result_cache.entries);
+    result_cache.entries = entries;
+    result_cache.size = maxsize;
+    result_cache.datetimes = datetimes;
+    result_cache.hits = 0;
+    result_cache.misses = 0;
+    Py_RETURN_NONE;
+}
+
+PyObject *
+get_result_cache_info(void)
+{
+    return Py_BuildValue(
+        "{sKsKsnsnsO}", "hits", result_cache.hits, "misses",
+        result_cache.misses, "maxsize", result_cache.size, "currsize",
+        result_cache.count, "datetimes",
+        result_cache.datetimes ? Py_True : Py_False);
+}
+
+/* How to parse (and validate, without raising) one type */
+typedef struct {
+    void (*parse_slice)(const isoformat_slice *, isoformat_fields *);
+    int (*is_valid)(const isoformat_fields *);
+    PyObject *(*from_fields)(const isoformat_fields *, PyObject *);
+    // Whether its results can be kept in the result cache below
+    int cache_type;
+} isoformat_parser;
+
+static const isoformat_parser date_parser = {
+    parse_date_slice, is_valid_date_fields, new_date_from_fields,
+    RESULT_CACHE_DATE};
+static const isoformat_parser time_parser = {
+    parse_time_slice, is_valid_time_fields, new_time_from_fields,
+    RESULT_CACHE_NONE};
+static const isoformat_parser datetime_parser = {
+    parse_datetime_slice, is_valid_datetime_fields,
+    new_datetime_from_fields, RESULT_CACHE_DATETIME};
+
+
+/* Parse `obj`, a str or (if `allow_buffer`) a bytes-like object, into `f`
+ * (with f->rv < 0 if it's invalid, without raising). Return -1 with an
+ * exception set if it can't be parsed at all, else 0.
+ */
+static int
+parse_fromisoformat_object(const isoformat_parser *parser, PyObject *obj,
+                           int allow_buffer, isoformat_fields *f)
+{
+    isoformat_slice slice;
+
+    if (PyUnicode_Check(obj)) {
+        if (PyUnicode_READY(obj) < 0) {
+            return -1;
+        }
+
+        slice.kind = PyUnicode_IS_ASCII(obj) ? UTF8_KIND : PyUnicode_KIND(obj);
+        slice.data = PyUnicode_DATA(obj);
+        slice.len = PyUnicode_GET_LENGTH(obj);
+
+        // Only datetimes have a separator, and we only need to copy the
+        // string if it's a surrogate character.
+        Py_UCS4 *copy = NULL;
+        if (parser == &datetime_parser && slice.kind != UTF8_KIND &&
+            slice.kind != PyUnicode_1BYTE_KIND) {
+            const Py_ssize_t separator =
+                _find_surrogate_separator(slice.kind, slice.data, slice.len);
+            if (separator) {
+                copy = PyUnicode_AsUCS4Copy(obj);
+                if (copy == NULL) {
+                    return -1;
+                }
+                copy[separator] = 'T';
+                slice.kind = PyUnicode_4BYTE_KIND;
+                slice.data = copy;
+            }
+        }
+
+        parser->parse_slice(&slice, f);
+        PyMem_Free(copy);
+        return 0;
+    }
+
+    if (!allow_buffer) {
+        PyErr_SetString(PyExc_TypeError,
+                        "fromisoformat: argument must be str");
+        return -1;
+    }
+    if (!PyObject_CheckBuffer(obj)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "fromisoformat: argument must be str or a "
+                        "bytes-like object");
+        return -1;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) < 0) {
+        return -1;
+    }
+    slice.kind = UTF8_KIND;
+    slice.data = view.buf;
+    slice.len = view.len;
+    parser->parse_slice(&slice, f);
+    PyBuffer_Release(&view);
+    return 0;
+}
+
+/* Return the result for the fields parsed from `obj`. If `invalid` isn't
+ * NULL, it is returned for invalid strings instead of raising ValueError.
+ */
+static PyObject *
+fromisoformat_fields(const isoformat_parser *parser,
+                     const isoformat_fields *f, PyObject *obj,
+                     PyObject *invalid)
+{
+    if (invalid != NULL && !parser->is_valid(f)) {
+        Py_INCREF(invalid);
+        return invalid;
+    }
+
+    return parser->from_fields(f, obj);
+}
+
+/* Like fromisoformat_fields, for the fields parsed from `slice`, with the
+ * result cache. `f` is parsed from the slice here if `parse` is true.
+ */
+static PyObject *
+fromisoformat_slice_fields(const isoformat_parser *parser,
+                           const isoformat_slice *slice, isoformat_fields *f,
+                           int parse, PyObject *obj, PyObject *invalid)
+{
+    result_cache_entry *entry = result_cache_slot(parser->cache_type, slice);
+    if (entry != NULL) {
+        PyObject *result =
+            result_cache_lookup(entry, parser->cache_type, slice);
+        if (result != NULL) {
+            return result;
+        }
+    }
+
+    if (parse) {
+        parser->parse_slice(slice, f);
+    }
+    PyObject *result = fromisoformat_fields(parser, f, obj, invalid);
+    if (entry != NULL && result != NULL && parser->is_valid(f)) {
+        result_cache_store(entry, parser->cache_type, slice, result);
+    }
+    return result;
+}
+
+static PyObject *
+fromisoformat_object(const isoformat_parser *parser, PyObject *obj,
+                     int allow_buffer, PyObject *invalid)
+{
+    isoformat_fields f;
+
+    if (result_cache.size > 0 && parser->cache_type != RESULT_CACHE_NONE) {
+        isoformat_slice slice = {UTF8_KIND, NULL, 0};
+        if (PyUnicode_Check(obj) && PyUnicode_IS_READY(obj) &&
+            PyUnicode_IS_ASCII(obj)) {
+            slice.data = PyUnicode_DATA(obj);
+            slice.len = PyUnicode_GET_LENGTH(obj);
+        }
+        else if (allow_buffer && PyBytes_CheckExact(obj)) {
+            slice.data = PyBytes_AS_STRING(obj);
+            slice.len = PyBytes_GET_SIZE(obj);
+        }
+        if (slice.data != NULL) {
+            return fromisoformat_slice_fields(parser, &slice, &f, 1, obj,
+                                              invalid);
+        }
+    }
+
+    if (parse_fromisoformat_object(parser, obj, allow_buffer, &f) < 0) {
+        return NULL;
+    }
+
+    return fromisoformat_fields(parser, &f, obj, invalid);
+}
+
+/* Return the new date from a string as generated by date.isoformat() */
+PyObject *
+date_fromisoformat(PyObject *dtstr)
+{
+    assert(dtstr != NULL);
+    return fromisoformat_object(&date_parser, dtstr, 0, NULL);
+}
+
+PyObject *
+time_fromisoformat(PyObject *tstr)
+{
+    assert(tstr != NULL);
+    return fromisoformat_object(&time_parser, tstr, 0, NULL);
+}
+
+PyObject *
+datetime_fromisoformat(PyObject *dtstr)
+{
+    assert(dtstr != NULL);
+    return fromisoformat_object(&datetime_parser, dtstr, 0, NULL);
+}
+
+/* Parse either a str (as the *_fromisoformat functions above do) or the
+ * contents of any object supporting the buffer protocol, in place.
+ * Buffers are expected to contain a UTF-8 encoded string.
+ */
+PyObject *
+date_fromisoformat_any(PyObject *dtstr, PyObject *invalid)
+{
+    return fromisoformat_object(&date_parser, dtstr, 1, invalid);
+}
+
+PyObject *
+time_fromisoformat_any(PyObject *tstr, PyObject *invalid)
+{
+    return fromisoformat_object(&time_parser, tstr, 1, invalid);
+}
+
+PyObject *
+datetime_fromisoformat_any(PyObject *dtstr, PyObject *invalid)
+{
+    return fromisoformat_object(&datetime_parser, dtstr, 1, invalid);
+}
+
+
+/* Set `*invalid` to what to return for invalid strings, given the errors
+ * and default arguments: NULL to raise ValueError (errors='raise', the
+ * default), None (errors='coerce') or `default_value` (errors='default', or
+ * None if it is NULL). Return -1 with an exception set for any other errors
+ * value, else 0.
+ */
+int
+get_invalid_result(PyObject *errors, PyObject *default_value,
+                   PyObject **invalid)
+{
+    *invalid = NULL;
+    if (errors == NULL) {
+        return 0;
+    }
+
+    if (!PyUnicode_Check(errors)) {
+        PyErr_Format(PyExc_TypeError, "errors must be a str, not %.200s",
+                     Py_TYPE(errors)->tp_name);
+        return -1;
+    }
+    if (PyUnicode_CompareWithASCIIString(errors, "raise") == 0) {
+        return 0;
+    }
+    if (PyUnicode_CompareWithASCIIString(errors, "coerce") == 0) {
+        *invalid = Py_None;
+        return 0;
+    }
+    if (PyUnicode_CompareWithASCIIString(errors, "default") == 0) {
+        *invalid = default_value != NULL ? default_value : Py_None;
+        return 0;
+    }
+
+    PyErr_Format(PyExc_ValueError,
+                 "errors must be 'raise', 'coerce' or 'default', not %R",
+                 errors);
+    return -1;
+}
+
+/* Seconds since the Unix epoch of a valid date and time, at UTC offset
+ * `tzoffset` (in seconds).
+ */
+static long long
+epoch_seconds(int year, int month, int day, int hour, int minute,
+              int second, int tzoffset)
+{
+    const long long days =
+        ymd_to_ord(year, month, day) - ymd_to_ord(1970, 1, 1);
+    return days * 86400 + hour * 3600 + minute * 60 + second - tzoffset;
+}
+
+/* Microseconds since the epoch always fit in 64 bits for years in
+ * [MINYEAR, MAXYEAR], nanoseconds only when the seconds are in
+ * (-NS_EPOCH_SECONDS_LIMIT, NS_EPOCH_SECONDS_LIMIT), about 292 years around
+ * the epoch.
+ */
+#define NS_EPOCH_SECONDS_LIMIT (LLONG_MAX / 1000000000 - 1)
+
+/* Return the number of microseconds (or nanoseconds) since the Unix epoch
+ * corresponding to a datetime string, without creating the datetime. Naive
+ * datetimes are taken to be in UTC. If `invalid` isn't NULL, it is returned
+ * for invalid strings instead of raising ValueError.
+ */
+PyObject *
+datetime_fromisoformat_to_epoch(PyObject *dtstr, int nanoseconds,
+                                PyObject *invalid)
+{
+    isoformat_fields f;
+    if (parse_fromisoformat_object(&datetime_parser, dtstr, 1, &f) < 0) {
+        return NULL;
+    }
+    if (invalid != NULL && !is_valid_datetime_fields(&f)) {
+        Py_INCREF(invalid);
+        return invalid;
+    }
+
+    const int year = f.year, month = f.month, day = f.day;
+    const int hour = f.hour, minute = f.minute, second = f.second;
+    const int microsecond = f.microsecond, nanosecond = f.nanosecond;
+    const int rv = f.rv;
+    int tzoffset = f.tzoffset, tzusec = f.tzusec;
+
+    if (rv < 0) {
+        PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", dtstr);
+        return NULL;
+    }
+
+    // The same validation (in the same order) as datetime_fromisoformat's
+    if (rv == 0) {
+        tzoffset = tzusec = 0;
+    }
+    else if (check_utc_offset(tzoffset) < 0) {
+        return NULL;
+    }
+    if (check_date_args(year, month, day) < 0 ||
+        check_time_args(hour, minute, second, microsecond, 0) < 0) {
+        return NULL;
+    }
+
+    const long long seconds = epoch_seconds(year, month, day, hour, minute,
+                                            second, tzoffset);
+    const long long microseconds = microsecond - tzusec;
+    if (!nanoseconds) {
+        return PyLong_FromLongLong(seconds * 1000000 + microseconds);
+    }
+
+    const long long subsecond = microseconds * 1000 + nanosecond;
+    if (seconds > -NS_EPOCH_SECONDS_LIMIT &&
+        seconds < NS_EPOCH_SECONDS_LIMIT) {
+        return PyLong_FromLongLong(seconds * 1000000000 + subsecond);
+    }
+
+    PyObject *result = NULL;
+    PyObject *scale = PyLong_FromLong(1000000000);
+    PyObject *pyseconds = PyLong_FromLongLong(seconds);
+    PyObject *pysubsecond = PyLong_FromLongLong(subsecond);
+    PyObject *scaled = NULL;
+    if (scale == NULL || pyseconds == NULL || pysubsecond == NULL) {
+        goto done;
+    }
+
+    scaled = PyNumber_Multiply(pyseconds, scale);
+    if (scaled != NULL) {
+        result = PyNumber_Add(scaled, pysubsecond);
+    }
+
+done:
+    Py_XDECREF(scale);
+    Py_XDECREF(pyseconds);
+    Py_XDECREF(pysubsecond);
+    Py_XDECREF(scaled);
+    return result;
+}
+
+static int
+is_isoformat_char(Py_UCS4 c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == ':' || c == '.' ||
+           c == ',' || c == '+' || c == 'W' || c == 'Z' || c == 'T';
+}
+
+/* Return the length of the longest run of code units at the start of
+ * `data` that could be part of a datetime string: the characters that
+ * appear in the grammar, plus one separator (of any character) where
+ * _find_isoformat_datetime_separator can find one.
+ */
+static Py_ssize_t
+isoformat_prefix_span(int kind, const void *data, Py_ssize_t len)
+{
+    const unsigned char *bytes = data;
+    unsigned char has_separator = 0;
+    Py_ssize_t i = 0;
+
+    while (i < len) {
+        const Py_UCS4 c =
+            kind == UTF8_KIND ? bytes[i] : PyUnicode_READ(kind, data, i);
+        ++i;
+        if (is_isoformat_char(c)) {
+            continue;
+        }
+        if (has_separator || (i - 1 != 7 && i - 1 != 8 && i - 1 != 10)) {
+            return i - 1;
+        }
+
+        has_separator = 1;
+        if (kind == UTF8_KIND && c >= 0x80) {
+            // The continuation bytes of a multi-byte separator
+            while (i < len && (bytes[i] & 0xc0) == 0x80) {
+                ++i;
+            }
+        }
+    }
+
+    return i;
+}
+
+/* The longest prefix is found by parsing candidate prefixes from the end of
+ * the span down, which would take quadratic time on long spans. These bound
+ * the candidates to those that can be valid, from the grammar:
+ *
+ * - Past PREFIX_TIME_START (the time starts at 8, 9 or 11), a valid string
+ *   has at most one of 'Z', '+' and '-', the sign of its UTC offset.
+ * - Without counting digits past PREFIX_DIGIT_RUN_MAX in a run, which can
+ *   only be the truncated digits of a fraction, the time has at most
+ *   PREFIX_TIME_MAX code units from PREFIX_TIME_START (up to 3 more bytes
+ *   of the separator, then HH:MM:SS. and its fraction) before the sign, and
+ *   so does the UTC offset from it. In between, the parser skips anything.
+ * - Truncating a string by two digits in such a run doesn't change how it
+ *   parses (by one, it can move the separator of YYYYWww dates), so once
+ *   the two longest candidates in a run have failed, so do the others.
+ */
+#define PREFIX_TIME_START 11
+#define PREFIX_DIGIT_RUN_MAX 32
+#define PREFIX_TIME_MAX (12 + PREFIX_DIGIT_RUN_MAX)
+
+static inline Py_UCS4
+read_prefix_char(int kind, const void *data, Py_ssize_t i)
+{
+    return kind == UTF8_KIND ? ((const unsigned char *)data)[i]
+                             : PyUnicode_READ(kind, data, i);
+}
+
+/* Return the longest end in [from, to] such that [from, end) has at most
+ * PREFIX_TIME_MAX code units, besides the digits of long runs.
+ */
+static Py_ssize_t
+prefix_time_end(int kind, const void *data, Py_ssize_t from, Py_ssize_t to)
+{
+    Py_ssize_t structure = 0, digits = 0;
+    for (Py_ssize_t i = from; i < to; ++i) {
+        digits = is_digit(read_prefix_char(kind, data, i)) ? digits + 1 : 0;
+        if (digits <= PREFIX_DIGIT_RUN_MAX && ++structure > PREFIX_TIME_MAX) {
+            return i;
+        }
+    }
+    return to;
+}
+
+/* Return the length of the run of digits that ends at `end` */
+static Py_ssize_t
+prefix_digit_run(int kind, const void *data, Py_ssize_t end)
+{
+    Py_ssize_t start = end;
+    while (start > 0 && is_digit(read_prefix_char(kind, data, start - 1))) {
+        --start;
+    }
+    return end - start;
+}
+
+/* Parse the longest prefix of `dtstr` (a str or bytes-like object) from
+ * code unit `pos` which datetime_fromisoformat accepts, and return
+ * (datetime, end), where `end` is the position just after that prefix.
+ *
+ * Candidate prefixes are tried from the longest run of characters that can
+ * appear in a datetime string (skipping those that parse the same, in long
+ * runs of digits), so the result is always the same as
+ * datetime_fromisoformat(dtstr[pos:end]). If `invalid` isn't NULL, it is
+ * returned instead of raising ValueError when there is no such prefix.
+ */
+PyObject *
+parse_isoformat_prefix(PyObject *dtstr, Py_ssize_t pos, PyObject *invalid)
+{
+    int kind;
+    const void *data;
+    Py_ssize_t len;
+    Py_buffer view;
+    view.obj = NULL;
+
+    if (PyUnicode_Check(dtstr)) {
+        if (PyUnicode_READY(dtstr) < 0) {
+            return NULL;
+        }
+        kind = PyUnicode_KIND(dtstr);
+        data = PyUnicode_DATA(dtstr);
+        len = PyUnicode_GET_LENGTH(dtstr);
+    }
+    else if (PyObject_CheckBuffer(dtstr)) {
+        if (PyObject_GetBuffer(dtstr, &view, PyBUF_SIMPLE) < 0) {
+            return NULL;
+        }
+        kind = UTF8_KIND;
+        data = view.buf;
+        len = view.len;
+    }
+    else {
+        PyErr_SetString(PyExc_TypeError,
+                        "parse_isoformat_prefix: argument must be str or a "
+                        "bytes-like object");
+        return NULL;
+    }
+
+    PyObject *result = NULL;
+    if (pos < 0 || pos > len) {
+        PyErr_Format(PyExc_IndexError,
+                     "pos must be in [0, %zd], not %zd", len, pos);
+        goto done;
+    }
+
+    const char *start =
+        (const char *)data + pos * (kind == UTF8_KIND ? 1 : kind);
+    isoformat_fields f = empty_isoformat_fields;
+    Py_ssize_t end = isoformat_prefix_span(kind, start, len - pos);
+    Py_ssize_t sign = -1, time_end = end;
+    if (end > PREFIX_TIME_START) {
+        for (Py_ssize_t i = PREFIX_TIME_START; i < end; ++i) {
+            const Py_UCS4 c = read_prefix_char(kind, start, i);
+            if (c == 'Z' || c == '+' || c == '-') {
+                if (sign >= 0) {
+                    end = i;
                     break;
+                }
+                sign = i;
+            }
+        }
+        time_end = prefix_time_end(kind, start, PREFIX_TIME_START,
+                                   sign >= 0 ? sign : end);
+        end = sign >= 0 ? prefix_time_end(kind, start, sign, end) : time_end;
+    }
+
+    f.rv = -1;
+    Py_ssize_t failed = -1;
+    // All valid strings are at least 7 characters long
+    while (end >= 7) {
+        if (end <= sign && end > time_end) {
+            end = time_end;
+            continue;
+        }
+
+        parse_isoformat_datetime_fields(kind, start, end, &f);
+        if (is_valid_datetime_fields(&f)) {
+            break;
+        }
+        f.rv = -1;
+
+        const Py_ssize_t run = prefix_digit_run(kind, start, end);
+        if (failed == end + 1 && run > PREFIX_DIGIT_RUN_MAX &&
+            is_digit(read_prefix_char(kind, start, end))) {
+            failed = end;
+            end -= run - PREFIX_DIGIT_RUN_MAX + 1;
+        }
+        else {
+            failed = end--;
+        }
+    }
+
+    if (f.rv < 0 && invalid != NULL) {
+        Py_INCREF(invalid);
+        result = invalid;
+        goto done;
+    }
+    if (f.rv < 0) {
+        PyErr_Format(PyExc_ValueError,
+                     "Invalid isoformat string at position %zd: %R", pos,
+                     dtstr);
+        goto done;
+    }
+
+    PyObject *dt = new_datetime_from_fields(&f, dtstr);
+    if (dt != NULL) {
+        result = Py_BuildValue("(Nn)", dt, pos + end);
+    }
+
+done:
+    if (view.obj != NULL) {
+        PyBuffer_Release(&view);
+    }
+    return result;
+}
+
+/* A parser for streams of datetime strings, such as sorted log timestamps,
+ * which remembers the date and separator of the last string it parsed.
+ * When the next string starts with the same code units, only its time is
+ * parsed, skipping the date grammar (and iso_to_ymd for week dates).
+ */
+#define INCREMENTAL_PREFIX_MAX 16
+
+typedef struct {
+    PyObject_HEAD
+    // What to return for invalid strings, or NULL to raise ValueError
+    PyObject *invalid;
+    // The date and separator of the last valid string, as ASCII code units
+    unsigned char prefix[INCREMENTAL_PREFIX_MAX];
+    // The length of `prefix`, or 0 if there is none
+    Py_ssize_t prefix_len;
+    int year, month, day;
+} IncrementalParser;
+
+static Py_ssize_t
+find_datetime_separator_kind(int kind, const void *data, Py_ssize_t len)
+{
+    return kind == UTF8_KIND
+               ? _find_isoformat_datetime_separator_utf8(data, len)
+               : _find_isoformat_datetime_separator_ucs1(data, len);
+}
+
+/* Parse a slice of 1-byte code units (UTF8_KIND or PyUnicode_1BYTE_KIND) as
+ * parse_datetime_slice would, reusing the date of the last string if it
+ * starts with the same prefix, and remembering the prefix of this one.
+ */
+static void
+parse_incremental_slice(IncrementalParser *self,
+                        const isoformat_slice *slice, isoformat_fields *f)
+{
+    const unsigned char *data = slice->data;
+    const Py_ssize_t len = slice->len;
+    const Py_ssize_t prefix_len = self->prefix_len;
+
+#ifdef HAVE_ISOFORMAT_SSE2
+    // Canonical strings are parsed faster as a whole
+    *f = empty_isoformat_fields;
+    f->rv = parse_isoformat_datetime_sse2(
+        data, len, &f->year, &f->month, &f->day, &f->hour, &f->minute,
+        &f->second, &f->microsecond, &f->tzoffset, &f->tzusec);
+    if (f->rv != -1) {
+        return;
+    }
+#endif
+
+    // The date can only be reused if the general grammar would put the
+    // separator in the same place; the fast paths give the same results.
+    if (prefix_len > 0 && len > prefix_len &&
+        memcmp(data, self->prefix, prefix_len) == 0 &&
+        find_datetime_separator_kind(slice->kind, data, len) ==
+            prefix_len - 1) {
+        *f = empty_isoformat_fields;
+        f->year = self->year;
+        f->month = self->month;
+        f->day = self->day;
+        if (slice->kind == UTF8_KIND) {
+            f->rv = parse_isoformat_time_utf8(
+                (const char *)data + prefix_len, len - prefix_len, &f->hour, &f->minute,
+                &f->second, &f->microsecond, &f->nanosecond, &f->tzoffset,
+                &f->tzusec);
+        }
+        else {
+            f->rv = parse_isoformat_time_ucs1(
+                data + prefix_len, len - prefix_len, &f->hour, &f->minute,
+                &f->second, &f->microsecond, &f->nanosecond, &f->tzoffset,
+                &f->tzusec);
+        }
+        return;
+    }
+
+    parse_datetime_slice(slice, f);
+    if (f->rv < 0 || !is_valid_date_fields(f) || len < 7) {
+        return;
+    }
+
+    const Py_ssize_t separator =
+        find_datetime_separator_kind(slice->kind, data, len);
+    if (separator < 0 || separator >= len ||
+        separator >= INCREMENTAL_PREFIX_MAX || data[separator] >= 0x80) {
+        return;
+    }
+    memcpy(self->prefix, data, separator + 1);
+    self->prefix_len = separator + 1;
+    self->year = f->year;
+    self->month = f->month;
+    self->day = f->day;
+}
+
+static PyObject *
+IncrementalParser_parse(IncrementalParser *self, PyObject *dtstr)
+{
+    isoformat_slice slice;
+    isoformat_fields f;
+
+    if (PyUnicode_Check(dtstr) && PyUnicode_READY(dtstr) == 0 &&
+        PyUnicode_KIND(dtstr) == PyUnicode_1BYTE_KIND) {
+        slice.kind = PyUnicode_IS_ASCII(dtstr) ? UTF8_KIND
+                                               : PyUnicode_1BYTE_KIND;
+        slice.data = PyUnicode_DATA(dtstr);
+        slice.len = PyUnicode_GET_LENGTH(dtstr);
+        parse_incremental_slice(self, &slice, &f);
+    }
+    else if (PyBytes_CheckExact(dtstr)) {
+        slice.kind = UTF8_KIND;
+        slice.data = PyBytes_AS_STRING(dtstr);
+        slice.len = PyBytes_GET_SIZE(dtstr);
+        parse_incremental_slice(self, &slice, &f);
+    }
+    else if (parse_fromisoformat_object(&datetime_parser, dtstr, 1, &f) < 0) {
+        return NULL;
+    }
+
+    return fromisoformat_fields(&datetime_parser, &f, dtstr, self->invalid);
+}
+
+static PyObject *
+IncrementalParser_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"errors", "default", NULL};
+    PyObject *errors = NULL, *default_value = Py_None, *invalid;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$OO:IncrementalParser",
+                                     keywords, &errors, &default_value) ||
+        get_invalid_result(errors, default_value, &invalid) < 0) {
+        return NULL;
+    }
+
+    IncrementalParser *self = PyObject_GC_New(IncrementalParser, type);
+    if (self == NULL) {
+        return NULL;
+    }
+    self->invalid = invalid;
+    Py_XINCREF(invalid);
+    self->prefix_len = 0;
+    PyObject_GC_Track(self);
+    return (PyObject *)self;
+}
+
+// `invalid` is the user's default, which may refer back to the parser
+static int
+IncrementalParser_traverse(IncrementalParser *self, visitproc visit,
+                           void *arg)
+{
+    Py_VISIT(self->invalid);
+    return 0;
+}
+
+static int
+IncrementalParser_clear(IncrementalParser *self)
+{
+    Py_CLEAR(self->invalid);
+    return 0;
+}
+
+static void
+IncrementalParser_dealloc(IncrementalParser *self)
+{
+    PyObject_GC_UnTrack(self);
+    IncrementalParser_clear(self);
+    PyObject_GC_Del(self);
+}
+
+static PyMethodDef IncrementalParser_methods[] = {
+    {"parse", (PyCFunction)IncrementalParser_parse, METH_O,
+     PyDoc_STR("Return a datetime corresponding to a date_string, as "
+               "datetime_fromisoformat would")},
+    {NULL}};
+
+static PyTypeObject IncrementalParser_type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "backports.datetime_fromisoformat.IncrementalParser", /* tp_name */
+    sizeof(IncrementalParser),                /* tp_basicsize */
+    0,                                        /* tp_itemsize */
+    (destructor)IncrementalParser_dealloc,    /* tp_dealloc */
+    0,                                        /* tp_print */
+    0,                                        /* tp_getattr */
+    0,                                        /* tp_setattr */
+    0,                                        /* tp_as_async */
+    0,                                        /* tp_repr */
+    0,                                        /* tp_as_number */
+    0,                                        /* tp_as_sequence */
+    0,                                        /* tp_as_mapping */
+    0,                                        /* tp_hash  */
+    0,                                        /* tp_call */
+    0,                                        /* tp_str */
+    0,                                        /* tp_getattro */
+    0,                                        /* tp_setattro */
+    0,                                        /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,  /* tp_flags */
+    "IncrementalParser(*, errors='raise', default=None)\n\n"
+    "Parses datetime strings as datetime_fromisoformat does, only parsing "
+    "the time of a string if it has the same date and separator as the last "
+    "one", /* tp_doc */
+    (traverseproc)IncrementalParser_traverse, /* tp_traverse */
+    (inquiry)IncrementalParser_clear,         /* tp_clear */
+};
+
+/* Parse every item of `iterable` as fromisoformat_object would, collecting
+ * the results into a new list. This saves the Python-level call dispatch per
+ * string, which dominates the cost of parsing short timestamps one at a
+ * time.
+ */
+static PyObject *
+fromisoformat_many(PyObject *iterable, const isoformat_parser *parser,
+                   PyObject *invalid)
+{
+    PyObject *seq = PySequence_Fast(
+        iterable, "fromisoformat_many: argument must be iterable");
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    const Py_ssize_t len = PySequence_Fast_GET_SIZE(seq);
+    PyObject *result = PyList_New(len);
+    if (result == NULL) {
+        goto error;
+    }
+
+    for (Py_ssize_t i = 0; i < len; ++i) {
+        // Creating the results can trigger garbage collection, which may run
+        // arbitrary code that mutates a list argument.
+        if (i >= PySequence_Fast_GET_SIZE(seq)) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "fromisoformat_many: sequence changed size "
+                            "during iteration");
+            goto error;
+        }
+
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        Py_INCREF(item);
+        PyObject *obj = fromisoformat_object(parser, item, 1, invalid);
+        Py_DECREF(item);
+
+        if (obj == NULL) {
+            goto error;
+        }
+        PyList_SET_ITEM(result, i, obj);
+    }
+
+    Py_DECREF(seq);
+    return result;
+
+error:
+    Py_XDECREF(result);
+    Py_DECREF(seq);
+    return NULL;
+}
+
+/* Strings are parsed on threads in blocks of this many items, which bounds
+ * the memory used for their results.
+ */
+#define ISOFORMAT_BLOCK_ITEMS (1 << 18)
+
+typedef struct {
+    const isoformat_parser *parser;
+    const isoformat_slice *slices;
+    isoformat_fields *fields;
+} parse_slices_task;
+
+static void
+parse_slices(void *arg, Py_ssize_t start, Py_ssize_t end)
+{
+    const parse_slices_task *task = arg;
+    for (Py_ssize_t i = start; i < end; ++i) {
+        if (task->slices[i].kind > 0) {
+            task->parser->parse_slice(&task->slices[i], &task->fields[i]);
+        }
+    }
+}
+
+/* Return a new tuple of the items of `iterable`, which keeps them alive (and
+ * unchanged) while the GIL is released, raising TypeError with `message` if
+ * it isn't iterable.
+ */
+static PyObject *
+get_items_tuple(PyObject *iterable, const char *message)
+{
+    PyObject *seq = PySequence_Fast(iterable, message);
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    PyObject *items = PySequence_Tuple(seq);
+    Py_DECREF(seq);
+    return items;
+}
+
+/* Like fromisoformat_many, but parse the strings on up to `threads` threads
+ * without the GIL, then create the results (and raise the same exception as
+ * fromisoformat_many for the first item that fails) with it.
+ */
+static PyObject *
+fromisoformat_many_parallel(PyObject *iterable,
+                            const isoformat_parser *parser, int threads,
+                            PyObject *invalid)
+{
+    PyObject *items = get_items_tuple(
+        iterable, "fromisoformat_many: argument must be iterable");
+    if (items == NULL) {
+        return NULL;
+    }
+
+    const Py_ssize_t len = PyTuple_GET_SIZE(items);
+    const Py_ssize_t block = Py_MIN(len, ISOFORMAT_BLOCK_ITEMS);
+    PyObject *result = PyList_New(len);
+    isoformat_slice *slices = PyMem_New(isoformat_slice, block);
+    isoformat_fields *fields = PyMem_New(isoformat_fields, block);
+    if (result == NULL || slices == NULL || fields == NULL) {
+        if (result != NULL) {
+            PyErr_NoMemory();
+        }
+        goto error;
+    }
+
+    parse_slices_task task = {parser, slices, fields};
+    for (Py_ssize_t base = 0; base < len; base += block) {
+        const Py_ssize_t count = Py_MIN(block, len - base);
+        for (Py_ssize_t i = 0; i < count; ++i) {
+            get_isoformat_slice(PyTuple_GET_ITEM(items, base + i),
+                                &slices[i]);
+        }
+
+        if (parallel_for(count, threads, parse_slices, &task) < 0) {
+            goto error;
+        }
+
+        for (Py_ssize_t i = 0; i < count; ++i) {
+            PyObject *item = PyTuple_GET_ITEM(items, base + i);
+            PyObject *obj =
+                slices[i].kind > 0
+                    ? fromisoformat_slice_fields(parser, &slices[i],
+                                                 &fields[i], 0, item, invalid)
+                    : fromisoformat_object(parser, item, 1, invalid);
+            if (obj == NULL) {
+                goto error;
+            }
+            PyList_SET_ITEM(result, base + i, obj);
+        }
+    }
+
+    PyMem_Free(slices);
+    PyMem_Free(fields);
+    Py_DECREF(items);
+    return result;
+
+error:
+    PyMem_Free(slices);
+    PyMem_Free(fields);
+    Py_XDECREF(result);
+    Py_DECREF(items);
+    return NULL;
+}
+
+static int
+check_threads(int threads)
+{
+    if (threads < 1) {
+        PyErr_Format(PyExc_ValueError,
+                     "threads must be at least 1, not %d", threads);
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+fromisoformat_many_threads(PyObject *iterable, const isoformat_parser *parser,
+                           int threads, PyObject *invalid)
+{
+    if (check_threads(threads) < 0) {
+        return NULL;
+    }
+    if (threads > 1) {
+        return fromisoformat_many_parallel(iterable, parser, threads,
+                                           invalid);
+    }
+    return fromisoformat_many(iterable, parser, invalid);
+}
+
+PyObject *
+date_fromisoformat_many(PyObject *iterable, int threads, PyObject *invalid)
+{
+    return fromisoformat_many_threads(iterable, &date_parser, threads,
+                                      invalid);
+}
+
+PyObject *
+time_fromisoformat_many(PyObject *iterable, int threads, PyObject *invalid)
+{
+    return fromisoformat_many_threads(iterable, &time_parser, threads,
+                                      invalid);
+}
+
+PyObject *
+datetime_fromisoformat_many(PyObject *iterable, int threads,
+                            PyObject *invalid)
+{
+    return fromisoformat_many_threads(iterable, &datetime_parser, threads,
+                                      invalid);
+}
+
+/* An iterator over the lines of a memory-mapped file, which parses them as
+ * datetime_fromisoformat would and yields lists of up to `chunk_size`
+ * results. Only the current chunk is held in memory, besides the pages of
+ * the mapping, which the OS can evict.
+ */
+typedef struct {
+    PyObject_HEAD
+    // The mmap.mmap object, or NULL once the iterator is exhausted
+    PyObject *mmap;
+    Py_buffer view;
+    Py_ssize_t pos;
+    Py_ssize_t chunk_size;
+    int threads;
+    // What to return for invalid lines, or NULL to raise ValueError
+    PyObject *invalid;
+    // Set while the GIL is released, to fail calls from other threads
+    int running;
+    isoformat_slice *slices;
+    isoformat_fields *fields;
+} LinesIterator;
+
+static void
+LinesIterator_close(LinesIterator *self)
+{
+    if (self->mmap != NULL) {
+        PyBuffer_Release(&self->view);
+        Py_CLEAR(self->mmap);
+    }
+    PyMem_Free(self->slices);
+    PyMem_Free(self->fields);
+    self->slices = NULL;
+    self->fields = NULL;
+}
+
+// `invalid` is the user's default, which may refer back to the iterator
+static int
+LinesIterator_traverse(LinesIterator *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->invalid);
+    return 0;
+}
+
+static int
+LinesIterator_clear(LinesIterator *self)
+{
+    Py_CLEAR(self->invalid);
+    return 0;
+}
+
+static void
+LinesIterator_dealloc(LinesIterator *self)
+{
+    PyObject_GC_UnTrack(self);
+    LinesIterator_close(self);
+    LinesIterator_clear(self);
+    PyObject_GC_Del(self);
+}
+
+static int
+is_line_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+typedef struct {
+    const char *data;
+    Py_ssize_t len;
+    Py_ssize_t pos;
+    Py_ssize_t max_lines;
+    isoformat_slice *slices;
+    Py_ssize_t count;
+} scan_lines_task;
+
+/* Fill `task->slices` with up to `task->max_lines` non-blank lines from
+ * `task->pos`, stripped of surrounding whitespace, and advance `task->pos`
+ * past them. Doesn't use the Python C API.
+ */
+static void
+scan_lines(scan_lines_task *task)
+{
+    const char *data = task->data;
+    Py_ssize_t pos = task->pos;
+    task->count = 0;
+
+    while (pos < task->len && task->count < task->max_lines) {
+        const char *newline = memchr(data + pos, '\n', task->len - pos);
+        Py_ssize_t end = newline != NULL ? newline - data : task->len;
+        Py_ssize_t start = pos;
+        pos = end + 1;
+
+        while (start < end && is_line_space(data[start])) {
+            ++start;
+        }
+        while (end > start && is_line_space(data[end - 1])) {
+            --end;
+        }
+        if (start == end) {
+            continue;
+        }
+
+        isoformat_slice *slice = &task->slices[task->count++];
+        slice->kind = UTF8_KIND;
+        slice->data = data + start;
+        slice->len = end - start;
+    }
+
+    task->pos = Py_MIN(pos, task->len);
+}
+
+static PyObject *
+LinesIterator_next(LinesIterator *self)
+{
+    if (self->mmap == NULL) {
+        return NULL;
+    }
+    if (self->running) {
+        PyErr_SetString(PyExc_ValueError, "iterator already executing");
+        return NULL;
+    }
+
+    scan_lines_task scan = {self->view.buf, self->view.len, self->pos,
+                            self->chunk_size, self->slices, 0};
+    self->running = 1;
+    Py_BEGIN_ALLOW_THREADS
+    scan_lines(&scan);
+    Py_END_ALLOW_THREADS
+
+    parse_slices_task parse = {&datetime_parser, self->slices, self->fields};
+    const int rv = parallel_for(scan.count, self->threads, parse_slices,
+                                &parse);
+    self->running = 0;
+    if (rv < 0) {
+        goto error;
+    }
+
+    self->pos = scan.pos;
+    if (scan.count == 0) {
+        LinesIterator_close(self);
+        return NULL;
+    }
+
+    PyObject *result = PyList_New(scan.count);
+    if (result == NULL) {
+        goto error;
+    }
+    for (Py_ssize_t i = 0; i < scan.count; ++i) {
+        PyObject *dt;
+        if (self->invalid != NULL &&
+            !is_valid_datetime_fields(&self->fields[i])) {
+            Py_INCREF(self->invalid);
+            dt = self->invalid;
+        }
+        else if (self->fields[i].rv < 0) {
+            // Only invalid lines need an object for the error message
+            PyObject *line = PyBytes_FromStringAndSize(self->slices[i].data,
+                                                       self->slices[i].len);
+            dt = line != NULL ? new_datetime_from_fields(&self->fields[i],
+                                                         line)
+                              : NULL;
+            Py_XDECREF(line);
+        }
+        else {
+            dt = new_datetime_from_fields(&self->fields[i], NULL);
+        }
+
+        if (dt == NULL) {
+            Py_DECREF(result);
+            goto error;
+        }
+        PyList_SET_ITEM(result, i, dt);
+    }
+
+    return result;
+
+error:
+    // Like a generator that raised, stop rather than resume after lines
+    // that were never returned
+    LinesIterator_close(self);
+    return NULL;
+}
+
+static PyTypeObject LinesIterator_type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "backports.datetime_fromisoformat.LinesIterator", /* tp_name */
+    sizeof(LinesIterator),                    /* tp_basicsize */
+    0,                                        /* tp_itemsize */
+    (destructor)LinesIterator_dealloc,        /* tp_dealloc */
+    0,                                        /* tp_print */
+    0,                                        /* tp_getattr */
+    0,                                        /* tp_setattr */
+    0,                                        /* tp_as_async */
+    0,                                        /* tp_repr */
+    0,                                        /* tp_as_number */
+    0,                                        /* tp_as_sequence */
+    0,                                        /* tp_as_mapping */
+    0,                                        /* tp_hash  */
+    0,                                        /* tp_call */
+    0,                                        /* tp_str */
+    0,                                        /* tp_getattro */
+    0,                                        /* tp_setattro */
+    0,                                        /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,  /* tp_flags */
+    "Iterator over chunks of datetimes parsed from the lines of a file", /* tp_doc */
+    (traverseproc)LinesIterator_traverse,     /* tp_traverse */
+    (inquiry)LinesIterator_clear,             /* tp_clear */
+};
+
+/* Return a new read-only mmap.mmap object of the file at `file` (a path or
+ * a file descriptor), or None if the file is empty, since those can't be
+ * mapped.
+ */
+static PyObject *
+map_file(PyObject *file)
+{
+    PyObject *fileobj = NULL, *fileno = NULL, *stat = NULL, *size = NULL;
+    PyObject *mmap_module = NULL, *result = NULL;
+
+    if (PyLong_Check(file)) {
+        fileno = file;
+        Py_INCREF(fileno);
+    }
+    else {
+        PyObject *io_module = PyImport_ImportModule("io");
+        if (io_module == NULL) {
+            goto done;
+        }
+        fileobj = PyObject_CallMethod(io_module, "open", "Os", file, "rb");
+        Py_DECREF(io_module);
+        if (fileobj == NULL) {
+            goto done;
+        }
+        fileno = PyObject_CallMethod(fileobj, "fileno", NULL);
+        if (fileno == NULL) {
+            goto done;
+        }
+    }
+
+    PyObject *os_module = PyImport_ImportModule("os");
+    if (os_module == NULL) {
+        goto done;
+    }
+    stat = PyObject_CallMethod(os_module, "fstat", "O", fileno);
+    Py_DECREF(os_module);
+    if (stat == NULL) {
+        goto done;
+    }
+    size = PyObject_GetAttrString(stat, "st_size");
+    if (size == NULL) {
+        goto done;
+    }
+    const int empty = PyObject_Not(size);
+    if (empty < 0) {
+        goto done;
+    }
+    if (empty) {
+        result = Py_None;
+        Py_INCREF(result);
+        goto done;
+    }
+
+    mmap_module = PyImport_ImportModule("mmap");
+    if (mmap_module == NULL) {
+        goto done;
+    }
+    PyObject *mmap_type = PyObject_GetAttrString(mmap_module, "mmap");
+    PyObject *access = PyObject_GetAttrString(mmap_module, "ACCESS_READ");
+    if (mmap_type != NULL && access != NULL) {
+        PyObject *args = Py_BuildValue("(Oi)", fileno, 0);
+        PyObject *kwargs = Py_BuildValue("{sO}", "access", access);
+        if (args != NULL && kwargs != NULL) {
+            result = PyObject_Call(mmap_type, args, kwargs);
+        }
+        Py_XDECREF(args);
+        Py_XDECREF(kwargs);
+    }
+    Py_XDECREF(mmap_type);
+    Py_XDECREF(access);
+
+done:
+    // The mapping stays valid after the file is closed
+    if (fileobj != NULL) {
+        PyObject *closed = PyObject_CallMethod(fileobj, "close", NULL);
+        if (closed == NULL) {
+            Py_CLEAR(result);
+        }
+        Py_XDECREF(closed);
+        Py_DECREF(fileobj);
+    }
+    Py_XDECREF(fileno);
+    Py_XDECREF(stat);
+    Py_XDECREF(size);
+    Py_XDECREF(mmap_module);
+    return result;
+}
+
+PyObject *
+datetime_fromisoformat_lines(PyObject *file, Py_ssize_t chunk_size,
+                             int threads, PyObject *invalid)
+{
+    if (check_threads(threads) < 0) {
+        return NULL;
+    }
+    if (chunk_size < 1) {
+        PyErr_Format(PyExc_ValueError,
+                     "chunk_size must be at least 1, not %zd", chunk_size);
+        return NULL;
+    }
+
+    PyObject *mmap = map_file(file);
+    if (mmap == NULL) {
+        return NULL;
+    }
+
+    LinesIterator *self =
+        PyObject_GC_New(LinesIterator, &LinesIterator_type);
+    if (self == NULL) {
+        Py_DECREF(mmap);
+        return NULL;
+    }
+    self->mmap = NULL;
+    self->pos = 0;
+    self->chunk_size = chunk_size;
+    self->threads = threads;
+    self->invalid = invalid;
+    Py_XINCREF(invalid);
+    self->running = 0;
+    self->slices = NULL;
+    self->fields = NULL;
+    PyObject_GC_Track(self);
+
+    if (mmap == Py_None) {
+        Py_DECREF(mmap);
+        return (PyObject *)self;
+    }
+
+    if (PyObject_GetBuffer(mmap, &self->view, PyBUF_SIMPLE) < 0) {
+        Py_DECREF(mmap);
+        Py_DECREF(self);
+        return NULL;
+    }
+    self->mmap = mmap;
+
+    self->slices = PyMem_New(isoformat_slice, chunk_size);
+    self->fields = PyMem_New(isoformat_fields, chunk_size);
+    if (self->slices == NULL || self->fields == NULL) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+
+    return (PyObject *)self;
+}
+
+/* Parse a str or bytes-like object as date_fromisoformat would. Return 0 on
+ * success, 1 if it isn't a valid date (without raising), or -1 with an
+ * exception set.
+ */
+static int
+parse_date_object(PyObject *obj, int *year, int *month, int *day)
+{
+    int rv;
+    if (PyUnicode_Check(obj)) {
+        if (PyUnicode_READY(obj) < 0) {
+            return -1;
+        }
+
+        const int kind = PyUnicode_KIND(obj);
+        const void *data = PyUnicode_DATA(obj);
+        const Py_ssize_t len = PyUnicode_GET_LENGTH(obj);
+        const Py_ssize_t utf8_len =
+            PyUnicode_IS_ASCII(obj) ? len : _utf8_length(kind, data, len);
+
+        if (utf8_len != 7 && utf8_len != 8 && utf8_len != 10) {
+            return 1;
+        }
+        rv = parse_isoformat_date_kind(kind, data, len, year, month, day);
+    }
+    else if (PyObject_CheckBuffer(obj)) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) < 0) {
+            return -1;
+        }
+
+        if (view.len != 7 && view.len != 8 && view.len != 10) {
+            rv = -1;
+        }
+        else {
+            rv = parse_isoformat_date_utf8(view.buf, view.len, year, month,
+                                           day);
+        }
+        PyBuffer_Release(&view);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "fromisoformat: argument must be str or a bytes-like "
+                     "object, not %.200s",
+                     Py_TYPE(obj)->tp_name);
+        return -1;
+    }
+
+    if (rv < 0 || !is_valid_date(*year, *month, *day)) {
+        return 1;
+    }
+    return 0;
+}
+
+/* Get a writable buffer of at least `min_len` bytes from `obj`, or from a
+ * new object created by `factory(min_len)` if `obj` is None. Return a new
+ * reference to the object the buffer came from, or NULL.
+ */
+static PyObject *
+get_output_buffer(PyObject *obj, Py_ssize_t min_len,
+                  PyObject *(*factory)(Py_ssize_t), const char *name,
+                  Py_buffer *view)
+{
+    if (obj == Py_None) {
+        obj = factory(min_len);
+        if (obj == NULL) {
+            return NULL;
+        }
+    }
+    else {
+        Py_INCREF(obj);
+    }
+
+    if (PyObject_GetBuffer(obj, view, PyBUF_WRITABLE) < 0) {
+        Py_DECREF(obj);
+        return NULL;
+    }
+
+    if (view->len < min_len) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be at least %zd bytes long, not %zd", name,
+                     min_len, view->len);
+        PyBuffer_Release(view);
+        Py_DECREF(obj);
+        return NULL;
+    }
+
+    return obj;
+}
+
+/* A new array.array of `count` zeros, of type `typecode` */
+static PyObject *
+new_zeroed_array(const char *typecode, Py_ssize_t count)
+{
+    PyObject *array_module = PyImport_ImportModule("array");
+    if (array_module == NULL) {
+        return NULL;
+    }
+
+    PyObject *zero = PyObject_CallMethod(array_module, "array", "s(i)",
+                                         typecode, 0);
+    Py_DECREF(array_module);
+    if (zero == NULL) {
+        return NULL;
+    }
+
+    PyObject *array = PySequence_Repeat(zero, count);
+    Py_DECREF(zero);
+    return array;
+}
+
+/* A new array.array('i') of `len` bytes, set to 0 */
+static PyObject *
+new_int32_array(Py_ssize_t len)
+{
+    return new_zeroed_array("i", len / (Py_ssize_t)sizeof(int32_t));
+}
+
+/* A new array.array('q') of `len` bytes, set to 0 */
+static PyObject *
+new_int64_array(Py_ssize_t len)
+{
+    return new_zeroed_array("q", len / (Py_ssize_t)sizeof(int64_t));
+}
+
+static PyObject *
+new_bitmap(Py_ssize_t len)
+{
+    return PyByteArray_FromStringAndSize(NULL, len);
+}
+
+typedef struct {
+    const isoformat_slice *slices;
+    // The outputs for the first slice
+    char *out;
+    unsigned char *validity;
+    int32_t epoch;
+} days_task;
+
+static void
+set_valid(unsigned char *validity, Py_ssize_t i)
+{
+    validity[i / 8] |= (unsigned char)(1 << (i % 8));
+}
+
+static void
+parse_days_slices(void *arg, Py_ssize_t start, Py_ssize_t end)
+{
+    const days_task *task = arg;
+    for (Py_ssize_t i = start; i < end; ++i) {
+        const isoformat_slice *slice = &task->slices[i];
+        int32_t days = 0;
+        if (slice->kind == SLICE_SERIAL) {
+            continue;
+        }
+        if (slice->kind != SLICE_NONE) {
+            isoformat_fields f;
+            parse_date_slice(slice, &f);
+            if (f.rv >= 0 && is_valid_date(f.year, f.month, f.day)) {
+                days = ymd_to_ord(f.year, f.month, f.day) - task->epoch;
+                set_valid(task->validity, i);
+            }
+        }
+
+        memcpy(task->out + i * sizeof(int32_t), &days, sizeof(int32_t));
+    }
+}
+
+/* Parse every date string of a sequence into an int32 number of days (since
+ * the epoch, or since the proleptic Gregorian ordinal 0 if `ordinal`) in
+ * `out`, and set the matching bit (least significant bit first) of
+ * `validity` to 1 if the string was valid, or to 0 (with 0 in `out`) if it
+ * wasn't or was None. The strings are parsed on up to `threads` threads,
+ * without the GIL. Return (out, validity).
+ */
+PyObject *
+date_fromisoformat_to_days(PyObject *strings, PyObject *out,
+                           PyObject *validity, int ordinal, int threads)
+{
+    if (check_threads(threads) < 0) {
+        return NULL;
+    }
+
+    PyObject *items = get_items_tuple(
+        strings, "date_fromisoformat_to_days: argument must be iterable");
+    if (items == NULL) {
+        return NULL;
+    }
+
+    const Py_ssize_t len = PyTuple_GET_SIZE(items);
+    const Py_ssize_t block = Py_MIN(len, ISOFORMAT_BLOCK_ITEMS);
+    Py_buffer out_view, validity_view;
+    PyObject *result = NULL;
+    isoformat_slice *slices = NULL;
+
+    out_view.obj = validity_view.obj = NULL;
+    out = get_output_buffer(out, len * (Py_ssize_t)sizeof(int32_t),
+                            new_int32_array, "out", &out_view);
+    if (out == NULL) {
+        validity = NULL;
+        goto done;
+    }
+    validity = get_output_buffer(validity, (len + 7) / 8, new_bitmap,
+                                 "validity", &validity_view);
+    if (validity == NULL) {
+        goto done;
+    }
+    slices = PyMem_New(isoformat_slice, block);
+    if (slices == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    char *out_buf = out_view.buf;
+    unsigned char *validity_buf = validity_view.buf;
+    const int32_t epoch = ordinal ? 0 : ymd_to_ord(1970, 1, 1);
+    memset(validity_buf, 0, (len + 7) / 8);
+
+    // Blocks start at multiples of 8 items, so at a byte of the bitmap
+    for (Py_ssize_t base = 0; base < len; base += block) {
+        const Py_ssize_t count = Py_MIN(block, len - base);
+        for (Py_ssize_t i = 0; i < count; ++i) {
+            get_isoformat_slice(PyTuple_GET_ITEM(items, base + i),
+                                &slices[i]);
+        }
+
+        days_task task = {slices, out_buf + base * sizeof(int32_t),
+                          validity_buf + base / 8, epoch};
+        if (parallel_for(count, threads, parse_days_slices, &task) < 0) {
+            goto done;
+        }
+
+        for (Py_ssize_t i = 0; i < count; ++i) {
+            if (slices[i].kind != SLICE_SERIAL) {
+                continue;
+            }
+
+            int year = 0, month = 0, day = 0;
+            int32_t days = 0;
+            const int rv = parse_date_object(PyTuple_GET_ITEM(items, base + i),
+                                             &year, &month, &day);
+            if (rv < 0) {
+                goto done;
+            }
+            if (rv == 0) {
+                days = ymd_to_ord(year, month, day) - epoch;
+                set_valid(task.validity, i);
             }
+            memcpy(task.out + i * sizeof(int32_t), &days, sizeof(int32_t));
         }
+    }
+
+    result = PyTuple_Pack(2, out, validity);
+
+done:
+    if (out_view.obj != NULL) {
+        PyBuffer_Release(&out_view);
+    }
+    if (validity_view.obj != NULL) {
+        PyBuffer_Release(&validity_view);
+    }
+    PyMem_Free(slices);
+    Py_XDECREF(out);
+    Py_XDECREF(validity);
+    Py_DECREF(items);
+    return result;
+}
 
-        len -= (p - dt_ptr);
-        rv = parse_isoformat_time(p, len, &hour, &minute, &second,
-                                  &microsecond, &tzoffset, &tzusec);
+/* The fields of a datetime string, for consumers with their own types */
+static PyStructSequence_Field isoformat_fields_fields[] = {
+    {"year", NULL},
+    {"month", NULL},
+    {"day", NULL},
+    {"hour", NULL},
+    {"minute", NULL},
+    {"second", NULL},
+    {"microsecond", NULL},
+    {"offset_seconds", "the whole seconds of the UTC offset, or 0"},
+    {"offset_microseconds",
+     "the microseconds of the UTC offset, with the sign of offset_seconds"},
+    {"has_offset", "whether the string has a UTC offset"},
+    {NULL, NULL},
+};
+
+static PyStructSequence_Desc isoformat_fields_desc = {
+    "backports.datetime_fromisoformat.IsoformatFields",
+    "The fields of a datetime string, as returned by parse_isoformat_fields",
+    isoformat_fields_fields, 10};
+
+static PyTypeObject IsoformatFields_type;
+
+/* Return an IsoformatFields of the fields of a datetime string, validated
+ * as datetime_fromisoformat does, without creating the datetime or its
+ * tzinfo. If `invalid` isn't NULL, it is returned for invalid strings
+ * instead of raising ValueError.
+ */
+PyObject *
+parse_isoformat_fields(PyObject *dtstr, PyObject *invalid)
+{
+    isoformat_fields f;
+    if (parse_fromisoformat_object(&datetime_parser, dtstr, 1, &f) < 0) {
+        return NULL;
     }
+    if (invalid != NULL && !is_valid_datetime_fields(&f)) {
+        Py_INCREF(invalid);
+        return invalid;
+    }
+
+    const int rv = f.rv;
+    int tzoffset = f.tzoffset, tzusec = f.tzusec;
+
     if (rv < 0) {
-        goto invalid_string_error;
+        PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", dtstr);
+        return NULL;
     }
 
-    PyObject *tzinfo = tzinfo_from_isoformat_results(rv, tzoffset, tzusec);
-    if (tzinfo == NULL) {
-        goto error;
+    // The same validation (in the same order) as datetime_fromisoformat's
+    if (rv == 0) {
+        tzoffset = tzusec = 0;
+    }
+    else if (check_utc_offset(tzoffset) < 0) {
+        return NULL;
+    }
+    if (check_date_args(f.year, f.month, f.day) < 0 ||
+        check_time_args(f.hour, f.minute, f.second, f.microsecond, 0) < 0) {
+        return NULL;
     }
 
-#if !PY_VERSION_AT_LEAST_36
-    /* Python 3.6+ does this validation as part of datetime's C API
-     * constructor. See
-     * https://github.com/python/cpython/commit/b67f0967386a9c9041166d2bbe0a421bd81e10bc
-     */
-    if (check_date_args(year, month, day) < 0) {
+    PyObject *result = PyStructSequence_New(&IsoformatFields_type);
+    if (result == NULL) {
         return NULL;
     }
-    if (check_time_args(hour, minute, second, microsecond, 0) < 0) {
+
+    const int values[] = {f.year,   f.month,       f.day,    f.hour, f.minute,
+                          f.second, f.microsecond, tzoffset, tzusec};
+    for (int i = 0; i < (int)(sizeof(values) / sizeof(*values)); ++i) {
+        PyObject *value = PyLong_FromLong(values[i]);
+        if (value == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyStructSequence_SET_ITEM(result, i, value);
+    }
+    PyObject *has_offset = rv == 1 ? Py_True : Py_False;
+    Py_INCREF(has_offset);
+    PyStructSequence_SET_ITEM(result, 9, has_offset);
+
+    return result;
+}
+
+/* Return 1 if `obj` (a str or bytes-like object) is a string the parser
+ * accepts, 0 if it isn't, or -1 with an exception set if it isn't a string.
+ * Nothing is allocated, except to copy strings with a surrogate separator.
+ */
+static int
+is_isoformat_object(const isoformat_parser *parser, PyObject *obj)
+{
+    isoformat_fields f;
+    if (parse_fromisoformat_object(parser, obj, 1, &f) < 0) {
+        return -1;
+    }
+    return parser->is_valid(&f);
+}
+
+static PyObject *
+is_isoformat_bool(const isoformat_parser *parser, PyObject *obj)
+{
+    const int rv = is_isoformat_object(parser, obj);
+    if (rv < 0) {
         return NULL;
     }
-    if (check_tzinfo_subclass(tzinfo) < 0) {
+    return PyBool_FromLong(rv);
+}
+
+PyObject *
+is_isoformat_date(PyObject *dtstr)
+{
+    return is_isoformat_bool(&date_parser, dtstr);
+}
+
+PyObject *
+is_isoformat_time(PyObject *tstr)
+{
+    return is_isoformat_bool(&time_parser, tstr);
+}
+
+PyObject *
+is_isoformat_datetime(PyObject *dtstr)
+{
+    return is_isoformat_bool(&datetime_parser, dtstr);
+}
+
+typedef struct {
+    const isoformat_parser *parser;
+    const isoformat_slice *slices;
+    // The bitmap for the first slice
+    unsigned char *validity;
+} validity_task;
+
+static void
+validate_slices(void *arg, Py_ssize_t start, Py_ssize_t end)
+{
+    const validity_task *task = arg;
+    for (Py_ssize_t i = start; i < end; ++i) {
+        if (task->slices[i].kind > 0) {
+            isoformat_fields f;
+            task->parser->parse_slice(&task->slices[i], &f);
+            if (task->parser->is_valid(&f)) {
+                set_valid(task->validity, i);
+            }
+        }
+    }
+}
+
+/* Set the bits of `validity` (least significant bit first) to whether each
+ * string of a sequence is one the parser accepts, on up to `threads`
+ * threads without the GIL. None is flagged as invalid. Return `validity`.
+ */
+static PyObject *
+is_isoformat_many(PyObject *strings, const isoformat_parser *parser,
+                  PyObject *validity, int threads)
+{
+    if (check_threads(threads) < 0) {
         return NULL;
     }
-#endif
 
-    PyObject *dt = PyDateTimeAPI->DateTime_FromDateAndTime(
-        year, month, day, hour, minute, second, microsecond, tzinfo,
-        PyDateTimeAPI->DateTimeType);
+    PyObject *items = get_items_tuple(
+        strings, "is_isoformat_many: argument must be iterable");
+    if (items == NULL) {
+        return NULL;
+    }
 
-    Py_DECREF(tzinfo);
-    Py_DECREF(dtstr_clean);
-    return dt;
+    const Py_ssize_t len = PyTuple_GET_SIZE(items);
+    const Py_ssize_t block = Py_MIN(len, ISOFORMAT_BLOCK_ITEMS);
+    Py_buffer validity_view;
+    PyObject *result = NULL;
+    isoformat_slice *slices = NULL;
 
-invalid_string_error:
-    PyErr_Format(PyExc_ValueError, "Invalid isoformat string: %R", dtstr);
+    validity = get_output_buffer(validity, (len + 7) / 8, new_bitmap,
+                                 "validity", &validity_view);
+    if (validity == NULL) {
+        Py_DECREF(items);
+        return NULL;
+    }
+    slices = PyMem_New(isoformat_slice, block);
+    if (slices == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
 
-error:
-    Py_XDECREF(dtstr_clean);
+    unsigned char *validity_buf = validity_view.buf;
+    memset(validity_buf, 0, (len + 7) / 8);
 
-    return NULL;
+    // Blocks start at multiples of 8 items, so at a byte of the bitmap
+    for (Py_ssize_t base = 0; base < len; base += block) {
+        const Py_ssize_t count = Py_MIN(block, len - base);
+        for (Py_ssize_t i = 0; i < count; ++i) {
+            get_isoformat_slice(PyTuple_GET_ITEM(items, base + i),
+                                &slices[i]);
+        }
+
+        validity_task task = {parser, slices, validity_buf + base / 8};
+        if (parallel_for(count, threads, validate_slices, &task) < 0) {
+            goto done;
+        }
+
+        for (Py_ssize_t i = 0; i < count; ++i) {
+            if (slices[i].kind != SLICE_SERIAL) {
+                continue;
+            }
+
+            const int rv =
+                is_isoformat_object(parser, PyTuple_GET_ITEM(items, base + i));
+            if (rv < 0) {
+                goto done;
+            }
+            if (rv) {
+                set_valid(task.validity, i);
+            }
+        }
+    }
+
+    Py_INCREF(validity);
+    result = validity;
+
+done:
+    PyBuffer_Release(&validity_view);
+    PyMem_Free(slices);
+    Py_DECREF(validity);
+    Py_DECREF(items);
+    return result;
 }
 
-void
-initialize_datetime_code(void)
+PyObject *
+is_isoformat_date_many(PyObject *strings, PyObject *validity, int threads)
+{
+    return is_isoformat_many(strings, &date_parser, validity, threads);
+}
+
+PyObject *
+is_isoformat_time_many(PyObject *strings, PyObject *validity, int threads)
+{
+    return is_isoformat_many(strings, &time_parser, validity, threads);
+}
+
+PyObject *
+is_isoformat_datetime_many(PyObject *strings, PyObject *validity,
+                           int threads)
+{
+    return is_isoformat_many(strings, &datetime_parser, validity, threads);
+}
+
+/* Parse `len` bytes of UTF-8 into the time since the epoch, as
+ * datetime_fromisoformat_to_epoch would. Return 0 on success, or -1 if the
+ * string is invalid or the result doesn't fit in 64 bits.
+ */
+static int
+parse_epoch_utf8(const char *data, Py_ssize_t len, int nanoseconds,
+                 int64_t *result)
+{
+    int year = 0, month = 0, day = 0;
+    int hour = 0, minute = 0, second = 0, microsecond = 0;
+    int nanosecond = 0, tzoffset = 0, tzusec = 0;
+
+    int rv = parse_isoformat_datetime_kind(
+        UTF8_KIND, data, len, &year, &month, &day, &hour, &minute, &second,
+        &microsecond, &nanosecond, &tzoffset, &tzusec);
+
+    if (rv < 0 || !is_valid_date(year, month, day) ||
+        !is_valid_time(hour, minute, second, microsecond)) {
+        return -1;
+    }
+    if (rv == 0) {
+        tzoffset = tzusec = 0;
+    }
+    else if (abs(tzoffset) >= 86400) {
+        return -1;
+    }
+
+    const long long seconds = epoch_seconds(year, month, day, hour, minute,
+                                            second, tzoffset);
+    const long long microseconds = microsecond - tzusec;
+    if (!nanoseconds) {
+        *result = seconds * 1000000 + microseconds;
+    }
+    else if (seconds > -NS_EPOCH_SECONDS_LIMIT &&
+             seconds < NS_EPOCH_SECONDS_LIMIT) {
+        *result = seconds * 1000000000 + microseconds * 1000 + nanosecond;
+    }
+    else {
+        return -1;
+    }
+
+    return 0;
+}
+
+typedef struct {
+    const uint8_t *nulls;
+    const int32_t *offsets32;
+    const int64_t *offsets64;
+    const char *data;
+    int64_t offset;
+    int large;
+    int nanoseconds;
+    char *out;
+    unsigned char *validity;
+} arrow_epoch_task;
+
+static void
+parse_arrow_epochs(void *arg, Py_ssize_t start, Py_ssize_t end)
+{
+    const arrow_epoch_task *task = arg;
+    for (Py_ssize_t i = start; i < end; ++i) {
+        const int64_t idx = task->offset + i;
+        int64_t value = 0;
+
+        if (task->nulls == NULL || (task->nulls[idx / 8] >> (idx % 8)) & 1) {
+            const int64_t first = task->large ? task->offsets64[idx]
+                                              : task->offsets32[idx];
+            const int64_t last = task->large ? task->offsets64[idx + 1]
+                                             : task->offsets32[idx + 1];
+            if (parse_epoch_utf8(task->data + first,
+                                 (Py_ssize_t)(last - first),
+                                 task->nanoseconds, &value) == 0) {
+                set_valid(task->validity, i);
+            }
+            else {
+                value = 0;
+            }
+        }
+
+        memcpy(task->out + i * sizeof(int64_t), &value, sizeof(int64_t));
+    }
+}
+
+/* Check the offsets of the `len` strings of `task` once, so that the workers
+ * can trust them: they must start at 0 or more and never decrease. The C
+ * data interface doesn't give the size of the data buffer, which the last
+ * offset defines, so there must only be one if that offset is past the
+ * first. Return 0, or -1 with a ValueError set.
+ */
+static int
+check_arrow_offsets(const arrow_epoch_task *task, Py_ssize_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+    if (task->large ? task->offsets64 == NULL : task->offsets32 == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "the Arrow string array has no offsets buffer");
+        return -1;
+    }
+
+    const int64_t first = task->large ? task->offsets64[task->offset]
+                                      : task->offsets32[task->offset];
+    int64_t previous = 0;
+    for (int64_t idx = task->offset; idx <= task->offset + len; ++idx) {
+        const int64_t current = task->large ? task->offsets64[idx]
+                                            : task->offsets32[idx];
+        if (current < previous) {
+            PyErr_SetString(PyExc_ValueError,
+                            "the offsets of the Arrow string array must be "
+                            "non-negative and never decrease");
+            return -1;
+        }
+        previous = current;
+    }
+    if (task->data == NULL && previous > first) {
+        PyErr_SetString(PyExc_ValueError,
+                        "the Arrow string array has no data buffer");
+        return -1;
+    }
+    return 0;
+}
+
+/* Parse every string of an Arrow string or large_string array, exported by
+ * `array` through the Arrow PyCapsule interface, into int64 microseconds (or
+ * nanoseconds) since the epoch in `out`, as datetime_fromisoformat_to_epoch
+ * would. The strings are read in place, on up to `threads` threads without
+ * the GIL. The matching bit (least significant bit first) of `validity` is
+ * set to 1 for valid strings, or to 0 (with 0 in `out`) for nulls and invalid
+ * strings. Return (out, validity).
+ */
+PyObject *
+datetime_fromisoformat_to_epoch_arrow(PyObject *array, int nanoseconds,
+                                      PyObject *out, PyObject *validity,
+                                      int threads)
+{
+    if (check_threads(threads) < 0) {
+        return NULL;
+    }
+
+    PyObject *capsules = NULL;
+    PyObject *result = NULL;
+    PyObject *out_obj = NULL, *validity_obj = NULL;
+    Py_buffer out_view, validity_view;
+    out_view.obj = validity_view.obj = NULL;
+
+    PyObject *export = PyObject_GetAttrString(array, "__arrow_c_array__");
+    if (export == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_AttributeError)) {
+            PyErr_Format(PyExc_TypeError,
+                         "expected an object supporting the Arrow PyCapsule "
+                         "interface (__arrow_c_array__), not %.200s",
+                         Py_TYPE(array)->tp_name);
+        }
+        goto done;
+    }
+    capsules = PyObject_CallObject(export, NULL);
+    Py_DECREF(export);
+    if (capsules == NULL) {
+        goto done;
+    }
+    if (!PyTuple_Check(capsules) || PyTuple_GET_SIZE(capsules) != 2) {
+        PyErr_SetString(PyExc_TypeError,
+                        "__arrow_c_array__ must return a tuple of two "
+                        "capsules");
+        goto done;
+    }
+
+    // The capsules release the structures when they are destroyed
+    struct ArrowSchema *schema = PyCapsule_GetPointer(
+        PyTuple_GET_ITEM(capsules, 0), "arrow_schema");
+    if (schema == NULL) {
+        goto done;
+    }
+    struct ArrowArray *arrow_array = PyCapsule_GetPointer(
+        PyTuple_GET_ITEM(capsules, 1), "arrow_array");
+    if (arrow_array == NULL) {
+        goto done;
+    }
+    if (schema->release == NULL || arrow_array->release == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "the Arrow array has already been released");
+        goto done;
+    }
+
+    int large;
+    if (strcmp(schema->format, "u") == 0) {
+        large = 0;
+    }
+    else if (strcmp(schema->format, "U") == 0) {
+        large = 1;
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "expected an Arrow string or large_string array, not "
+                     "format '%s'",
+                     schema->format);
+        goto done;
+    }
+    if (arrow_array->n_buffers != 3) {
+        PyErr_SetString(PyExc_ValueError,
+                        "an Arrow string array must have 3 buffers");
+        goto done;
+    }
+    if (arrow_array->length < 0 || arrow_array->offset < 0 ||
+        arrow_array->offset > INT64_MAX - arrow_array->length) {
+        PyErr_SetString(PyExc_ValueError,
+                        "invalid length or offset of an Arrow array");
+        goto done;
+    }
+    if (arrow_array->length > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(int64_t)) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    const Py_ssize_t len = (Py_ssize_t)arrow_array->length;
+    arrow_epoch_task task = {arrow_array->buffers[0],
+                             arrow_array->buffers[1],
+                             arrow_array->buffers[1],
+                             arrow_array->buffers[2],
+                             arrow_array->offset,
+                             large,
+                             nanoseconds,
+                             NULL,
+                             NULL};
+    if (check_arrow_offsets(&task, len) < 0) {
+        goto done;
+    }
+
+    out_obj = get_output_buffer(out, len * (Py_ssize_t)sizeof(int64_t),
+                                new_int64_array, "out", &out_view);
+    if (out_obj == NULL) {
+        goto done;
+    }
+    validity_obj = get_output_buffer(validity, (len + 7) / 8, new_bitmap,
+                                     "validity", &validity_view);
+    if (validity_obj == NULL) {
+        goto done;
+    }
+
+    task.out = out_view.buf;
+    task.validity = validity_view.buf;
+    memset(task.validity, 0, (len + 7) / 8);
+    if (parallel_for(len, threads, parse_arrow_epochs, &task) < 0) {
+        goto done;
+    }
+
+    result = PyTuple_Pack(2, out_obj, validity_obj);
+
+done:
+    if (out_view.obj != NULL) {
+        PyBuffer_Release(&out_view);
+    }
+    if (validity_view.obj != NULL) {
+        PyBuffer_Release(&validity_view);
+    }
+    Py_XDECREF(out_obj);
+    Py_XDECREF(validity_obj);
+    Py_XDECREF(capsules);
+    return result;
+}
+
+/* The functions of the C API, in datetime_fromisoformat_api.h */
+static int
+capi_parse_date(const char *dtstr, Py_ssize_t len, int *year, int *month,
+                int *day)
+{
+    const isoformat_slice slice = {UTF8_KIND, dtstr, len};
+    isoformat_fields f;
+    parse_date_slice(&slice, &f);
+    if (!is_valid_date_fields(&f)) {
+        return -1;
+    }
+
+    *year = f.year;
+    *month = f.month;
+    *day = f.day;
+    return 0;
+}
+
+static int
+capi_parse_time(const char *tstr, Py_ssize_t len, int *hour, int *minute,
+                int *second, int *microsecond, int *tzoffset, int *tzusec)
+{
+    const isoformat_slice slice = {UTF8_KIND, tstr, len};
+    isoformat_fields f;
+    parse_time_slice(&slice, &f);
+    if (!is_valid_time_fields(&f)) {
+        return -1;
+    }
+
+    *hour = f.hour;
+    *minute = f.minute;
+    *second = f.second;
+    *microsecond = f.microsecond;
+    *tzoffset = f.rv ? f.tzoffset : 0;
+    *tzusec = f.rv ? f.tzusec : 0;
+    return f.rv;
+}
+
+static int
+capi_parse_datetime(const char *dtstr, Py_ssize_t len, int *year,
+                    int *month, int *day, int *hour, int *minute,
+                    int *second, int *microsecond, int *tzoffset,
+                    int *tzusec)
+{
+    const isoformat_slice slice = {UTF8_KIND, dtstr, len};
+    isoformat_fields f;
+    parse_datetime_slice(&slice, &f);
+    if (!is_valid_datetime_fields(&f)) {
+        return -1;
+    }
+
+    *year = f.year;
+    *month = f.month;
+    *day = f.day;
+    *hour = f.hour;
+    *minute = f.minute;
+    *second = f.second;
+    *microsecond = f.microsecond;
+    *tzoffset = f.rv ? f.tzoffset : 0;
+    *tzusec = f.rv ? f.tzusec : 0;
+    return f.rv;
+}
+
+// Unlike the parser, outside callers may pass any offset
+static PyObject *
+capi_new_fixed_offset(int offset)
+{
+    if (check_utc_offset(offset) < 0) {
+        return NULL;
+    }
+    return new_fixed_offset(offset);
+}
+
+static PyObject *
+capi_new_tzinfo(int offset)
+{
+    if (check_utc_offset(offset) < 0) {
+        return NULL;
+    }
+    return new_tzinfo(offset);
+}
+
+static DatetimeFromIsoformat_CAPI capi = {
+    DATETIME_FROMISOFORMAT_API_VERSION,
+    capi_parse_date,
+    capi_parse_time,
+    capi_parse_datetime,
+    capi_new_fixed_offset,
+    capi_new_tzinfo,
+};
+
+int
+initialize_datetime_code(PyObject *module)
 {
     PyDateTime_IMPORT;
+#ifdef HAVE_ISOFORMAT_SSE2
+    initialize_isoformat_sse2();
+#endif
+
+    LinesIterator_type.tp_iter = PyObject_SelfIter;
+    LinesIterator_type.tp_iternext = (iternextfunc)LinesIterator_next;
+    if (PyType_Ready(&LinesIterator_type) < 0) {
+        return -1;
+    }
+
+    IncrementalParser_type.tp_new = IncrementalParser_new;
+    IncrementalParser_type.tp_methods = IncrementalParser_methods;
+    if (PyType_Ready(&IncrementalParser_type) < 0) {
+        return -1;
+    }
+
+    Py_INCREF(&IncrementalParser_type);
+    if (PyModule_AddObject(module, "IncrementalParser",
+                           (PyObject *)&IncrementalParser_type) < 0) {
+        Py_DECREF(&IncrementalParser_type);
+        return -1;
+    }
+
+    if (PyStructSequence_InitType2(&IsoformatFields_type,
+                                   &isoformat_fields_desc) < 0) {
+        return -1;
+    }
+
+    Py_INCREF(&IsoformatFields_type);
+    if (PyModule_AddObject(module, "IsoformatFields",
+                           (PyObject *)&IsoformatFields_type) < 0) {
+        Py_DECREF(&IsoformatFields_type);
+        return -1;
+    }
+
+    PyObject *capsule =
+        PyCapsule_New(&capi, DATETIME_FROMISOFORMAT_CAPSULE_NAME, NULL);
+    if (capsule == NULL) {
+        return -1;
+    }
+    if (PyModule_AddObject(module, "_C_API", capsule) < 0) {
+        Py_DECREF(capsule);
+        return -1;
+    }
+
+    return 0;
 }
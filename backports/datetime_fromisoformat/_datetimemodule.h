@@ -9,5 +9,108 @@ time_fromisoformat(PyObject *tstr);
 PyObject *
 datetime_fromisoformat(PyObject *dtstr);
 
+/* Set `*invalid` to what to return for invalid strings, given the errors
+ * and default arguments of the functions below (either of which may be NULL
+ * if it wasn't given).
+ */
+int
+get_invalid_result(PyObject *errors, PyObject *default_value,
+                   PyObject **invalid);
+
+/* Like the functions above, but also accept bytes-like objects. In these and
+ * the functions below, `invalid` is returned for invalid strings instead of
+ * raising ValueError, unless it is NULL.
+ */
+PyObject *
+date_fromisoformat_any(PyObject *dtstr, PyObject *invalid);
+
+PyObject *
+time_fromisoformat_any(PyObject *tstr, PyObject *invalid);
+
+PyObject *
+datetime_fromisoformat_any(PyObject *dtstr, PyObject *invalid);
+
+/* (datetime, end) for the longest valid prefix of a string from `pos` */
+PyObject *
+parse_isoformat_prefix(PyObject *dtstr, Py_ssize_t pos, PyObject *invalid);
+
+/* Parse every item of an iterable, on up to `threads` threads */
+PyObject *
+date_fromisoformat_many(PyObject *iterable, int threads, PyObject *invalid);
+
+PyObject *
+time_fromisoformat_many(PyObject *iterable, int threads, PyObject *invalid);
+
+PyObject *
+datetime_fromisoformat_many(PyObject *iterable, int threads,
+                            PyObject *invalid);
+
+/* Microseconds (or nanoseconds) since the epoch, naive strings being UTC */
+PyObject *
+datetime_fromisoformat_to_epoch(PyObject *dtstr, int nanoseconds,
+                                PyObject *invalid);
+
+/* Days since the epoch (or proleptic ordinals) of a sequence of dates */
+PyObject *
+date_fromisoformat_to_days(PyObject *strings, PyObject *out,
+                           PyObject *validity, int ordinal, int threads);
+
+/* An IsoformatFields of the fields of a datetime string */
+PyObject *
+parse_isoformat_fields(PyObject *dtstr, PyObject *invalid);
+
+/* Whether a str or bytes-like object is a string the corresponding
+ * *_fromisoformat function accepts, without creating any object.
+ */
+PyObject *
+is_isoformat_date(PyObject *dtstr);
+
+PyObject *
+is_isoformat_time(PyObject *tstr);
+
+PyObject *
+is_isoformat_datetime(PyObject *dtstr);
+
+/* The same for each string of a sequence, as a bitmap written into
+ * `validity` (a writable buffer, or None for a new bytearray), on up to
+ * `threads` threads.
+ */
+PyObject *
+is_isoformat_date_many(PyObject *strings, PyObject *validity, int threads);
+
+PyObject *
+is_isoformat_time_many(PyObject *strings, PyObject *validity, int threads);
+
+PyObject *
+is_isoformat_datetime_many(PyObject *strings, PyObject *validity,
+                           int threads);
+
+/* The same as int64 timestamps, from an Arrow string array */
+PyObject *
+datetime_fromisoformat_to_epoch_arrow(PyObject *array, int nanoseconds,
+                                      PyObject *out, PyObject *validity,
+                                      int threads);
+
+/* An iterator over the lines of a file, yielding lists of datetimes */
+PyObject *
+datetime_fromisoformat_lines(PyObject *file, Py_ssize_t chunk_size,
+                             int threads, PyObject *invalid);
+
+/* Enable the cache of the results for repeated strings with `maxsize` slots
+ * (or disable it, for 0), clearing it and its statistics.
+ */
+PyObject *
+set_result_cache(Py_ssize_t maxsize, int datetimes);
+
+PyObject *
+get_result_cache_info(void);
+
+/* Drop the cached results, eg. when the timezone mode changes */
 void
-initialize_datetime_code(void);
\ No newline at end of file
+clear_result_cache(void);
+
+/* Also adds the IncrementalParser and IsoformatFields types and the _C_API
+ * capsule to `module`
+ */
+int
+initialize_datetime_code(PyObject *module);
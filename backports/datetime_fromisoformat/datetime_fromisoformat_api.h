@@ -0,0 +1,75 @@
+/* The C API of backports.datetime_fromisoformat, for other extension modules.
+ *
+ * Like the datetime module's, it is a table of function pointers exported in
+ * a capsule. Include this header (its directory is returned by
+ * backports.datetime_fromisoformat.get_include()), then call
+ * DatetimeFromIsoformat_IMPORT once, eg. in the module's init function:
+ *
+ *   DatetimeFromIsoformat_IMPORT;
+ *   if (DatetimeFromIsoformatAPI == NULL) {
+ *       return NULL;
+ *   }
+ *
+ * The parse_* functions take a UTF-8 encoded string (which doesn't need to
+ * be NUL-terminated) and its length in bytes, accept the same strings as the
+ * corresponding *_fromisoformat functions, and store the fields of valid
+ * strings into their int outputs. They return -1 for invalid strings, 0 for
+ * naive times, and 1 for times with a UTC offset (of `tzoffset` seconds and
+ * `tzusec` microseconds). They don't use the Python API, so they can be
+ * called without holding the GIL.
+ */
+#ifndef DATETIME_FROMISOFORMAT_API_H
+#define DATETIME_FROMISOFORMAT_API_H
+
+#include <Python.h>
+
+#define DATETIME_FROMISOFORMAT_CAPSULE_NAME \
+    "backports._datetime_fromisoformat._C_API"
+
+/* Incremented when functions are added, at the end of the table */
+#define DATETIME_FROMISOFORMAT_API_VERSION 1
+
+typedef struct {
+    int version;
+
+    int (*parse_date)(const char *dtstr, Py_ssize_t len, int *year,
+                      int *month, int *day);
+    int (*parse_time)(const char *tstr, Py_ssize_t len, int *hour,
+                      int *minute, int *second, int *microsecond,
+                      int *tzoffset, int *tzusec);
+    int (*parse_datetime)(const char *dtstr, Py_ssize_t len, int *year,
+                          int *month, int *day, int *hour, int *minute,
+                          int *second, int *microsecond, int *tzoffset,
+                          int *tzusec);
+
+    /* A new reference to the FixedOffset for `offset` seconds, or NULL with
+     * an exception set (a ValueError if it's outside (-86400, 86400)).
+     */
+    PyObject *(*new_fixed_offset)(int offset);
+    /* The same for the tzinfo of the current timezone mode */
+    PyObject *(*new_tzinfo)(int offset);
+} DatetimeFromIsoformat_CAPI;
+
+/* Defined by the module itself, which exports the table */
+#ifndef DATETIME_FROMISOFORMAT_IMPL
+static DatetimeFromIsoformat_CAPI *DatetimeFromIsoformatAPI = NULL;
+
+/* Before Python 3.13, PyCapsule_Import doesn't import submodules */
+static inline DatetimeFromIsoformat_CAPI *
+DatetimeFromIsoformat_Import(void)
+{
+    PyObject *module =
+        PyImport_ImportModule("backports._datetime_fromisoformat");
+    if (module == NULL) {
+        return NULL;
+    }
+    Py_DECREF(module);
+    return (DatetimeFromIsoformat_CAPI *)PyCapsule_Import(
+        DATETIME_FROMISOFORMAT_CAPSULE_NAME, 0);
+}
+
+#define DatetimeFromIsoformat_IMPORT \
+    DatetimeFromIsoformatAPI = DatetimeFromIsoformat_Import()
+#endif
+
+#endif
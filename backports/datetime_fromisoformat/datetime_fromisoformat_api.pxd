@@ -0,0 +1,41 @@
+# The C API of backports.datetime_fromisoformat, for Cython modules (see datetime_fromisoformat_api.h).
+#
+#     from backports.datetime_fromisoformat.datetime_fromisoformat_api cimport (
+#         DatetimeFromIsoformatAPI, import_datetime_fromisoformat)
+#
+#     import_datetime_fromisoformat()
+#
+#     cdef int year, month, day
+#     if DatetimeFromIsoformatAPI.parse_date(s, len(s), &year, &month, &day) < 0:
+#         raise ValueError(s)
+#
+# with get_include() in the include_dirs of the extension.
+
+from cpython.object cimport PyObject
+
+cdef extern from "datetime_fromisoformat_api.h":
+    enum: DATETIME_FROMISOFORMAT_API_VERSION
+
+    ctypedef struct DatetimeFromIsoformat_CAPI:
+        int version
+
+        int parse_date(const char *dtstr, Py_ssize_t len, int *year, int *month, int *day) nogil
+        int parse_time(const char *tstr, Py_ssize_t len, int *hour, int *minute, int *second, int *microsecond,
+                       int *tzoffset, int *tzusec) nogil
+        int parse_datetime(const char *dtstr, Py_ssize_t len, int *year, int *month, int *day, int *hour,
+                           int *minute, int *second, int *microsecond, int *tzoffset, int *tzusec) nogil
+
+        PyObject *new_fixed_offset(int offset) except NULL
+        PyObject *new_tzinfo(int offset) except NULL
+
+    DatetimeFromIsoformat_CAPI *DatetimeFromIsoformatAPI
+
+    # A macro, which sets DatetimeFromIsoformatAPI (or leaves it NULL with an exception set)
+    void DatetimeFromIsoformat_IMPORT()
+
+
+cdef inline int import_datetime_fromisoformat() except -1:
+    DatetimeFromIsoformat_IMPORT
+    if DatetimeFromIsoformatAPI is NULL:
+        return -1
+    return 0
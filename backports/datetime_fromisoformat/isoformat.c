@@ -0,0 +1,325 @@
+#include "isoformat.h"
+
+#include <datetime.h>
+
+#include "timezone.h"
+
+/* YYYY-MM-DD, HH:MM:SS.ffffff and +HH:MM:SS.ffffff, the separator aside */
+#define DATETIME_MAX_LENGTH 25
+#define UTC_OFFSET_MAX_LENGTH 16
+#define SEP_MAX_LENGTH 4
+
+static const char *const timespec_names[] = {
+    "auto",          // TIMESPEC_AUTO
+    "hours",         // TIMESPEC_HOURS
+    "minutes",       // TIMESPEC_MINUTES
+    "seconds",       // TIMESPEC_SECONDS
+    "milliseconds",  // TIMESPEC_MILLISECONDS
+    "microseconds",  // TIMESPEC_MICROSECONDS
+};
+
+int
+get_timespec(PyObject *timespec)
+{
+    if (!PyUnicode_Check(timespec)) {
+        PyErr_Format(PyExc_TypeError, "timespec must be a str, not %.200s",
+                     Py_TYPE(timespec)->tp_name);
+        return -1;
+    }
+
+    for (int i = 0;
+         i < (int)(sizeof(timespec_names) / sizeof(*timespec_names)); ++i) {
+        if (PyUnicode_CompareWithASCIIString(timespec, timespec_names[i]) ==
+            0) {
+            return i;
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError, "Unknown timespec value: %R", timespec);
+    return -1;
+}
+
+typedef struct {
+    const char *sep;
+    Py_ssize_t sep_len;
+    int timespec;
+} isoformat_options;
+
+static inline char *
+write_digits(char *p, int value, int digits)
+{
+    for (int i = digits - 1; i >= 0; --i) {
+        p[i] = '0' + value % 10;
+        value /= 10;
+    }
+    return p + digits;
+}
+
+/* Write the UTC offset of `dt` as datetime.isoformat does, reading it
+ * directly from FixedOffset instances, and calling `tzinfo.utcoffset(dt)` for
+ * any other tzinfo. Return the end of what was written, or NULL with an
+ * exception set.
+ */
+static char *
+write_utc_offset(char *p, PyObject *dt, PyObject *tzinfo)
+{
+    int offset;
+    if (get_fixed_offset(tzinfo, &offset)) {
+        return p + format_utc_offset(p, offset, offset % 60 != 0);
+    }
+
+    PyObject *delta = PyObject_CallMethod(tzinfo, "utcoffset", "O", dt);
+    if (delta == NULL) {
+        return NULL;
+    }
+    if (delta == Py_None) {
+        Py_DECREF(delta);
+        return p;
+    }
+    if (!PyDelta_Check(delta)) {
+        PyErr_Format(PyExc_TypeError,
+                     "tzinfo.utcoffset() must return None or timedelta, "
+                     "not '%.200s'",
+                     Py_TYPE(delta)->tp_name);
+        Py_DECREF(delta);
+        return NULL;
+    }
+
+    long long microseconds =
+        ((long long)PyDateTime_DELTA_GET_DAYS(delta) * 86400 +
+         PyDateTime_DELTA_GET_SECONDS(delta)) *
+            1000000 +
+        PyDateTime_DELTA_GET_MICROSECONDS(delta);
+    Py_DECREF(delta);
+    if (microseconds <= -86400000000LL || microseconds >= 86400000000LL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "offset must be a timedelta strictly between "
+                        "-timedelta(hours=24) and timedelta(hours=24)");
+        return NULL;
+    }
+
+    const int negative = microseconds < 0;
+    if (negative) {
+        microseconds = -microseconds;
+    }
+    const int seconds = (int)(microseconds / 1000000);
+    const int fraction = (int)(microseconds % 1000000);
+
+    // The sign is written separately, for offsets of less than a second
+    char *start = p;
+    p += format_utc_offset(p, seconds, seconds % 60 != 0 || fraction != 0);
+    if (negative) {
+        *start = '-';
+    }
+    if (fraction != 0) {
+        *p++ = '.';
+        p = write_digits(p, fraction, 6);
+    }
+    return p;
+}
+
+/* Write dt.isoformat(sep, timespec), returning the end of what was written,
+ * or NULL with an exception set.
+ */
+static char *
+write_datetime(char *p, PyObject *dt, const isoformat_options *options)
+{
+    p = write_digits(p, PyDateTime_GET_YEAR(dt), 4);
+    *p++ = '-';
+    p = write_digits(p, PyDateTime_GET_MONTH(dt), 2);
+    *p++ = '-';
+    p = write_digits(p, PyDateTime_GET_DAY(dt), 2);
+    memcpy(p, options->sep, options->sep_len);
+    p += options->sep_len;
+
+    const int microsecond = PyDateTime_DATE_GET_MICROSECOND(dt);
+    int timespec = options->timespec;
+    if (timespec == TIMESPEC_AUTO) {
+        timespec = microsecond != 0 ? TIMESPEC_MICROSECONDS : TIMESPEC_SECONDS;
+    }
+
+    p = write_digits(p, PyDateTime_DATE_GET_HOUR(dt), 2);
+    if (timespec >= TIMESPEC_MINUTES) {
+        *p++ = ':';
+        p = write_digits(p, PyDateTime_DATE_GET_MINUTE(dt), 2);
+    }
+    if (timespec >= TIMESPEC_SECONDS) {
+        *p++ = ':';
+        p = write_digits(p, PyDateTime_DATE_GET_SECOND(dt), 2);
+    }
+    if (timespec == TIMESPEC_MILLISECONDS) {
+        *p++ = '.';
+        p = write_digits(p, microsecond / 1000, 3);
+    }
+    else if (timespec == TIMESPEC_MICROSECONDS) {
+        *p++ = '.';
+        p = write_digits(p, microsecond, 6);
+    }
+
+    PyDateTime_DateTime *datetime = (PyDateTime_DateTime *)dt;
+    if (datetime->hastzinfo && datetime->tzinfo != Py_None) {
+        p = write_utc_offset(p, dt, datetime->tzinfo);
+    }
+    return p;
+}
+
+/* Restore `out` to its original size after an error */
+static void
+truncate_out(PyObject *out, Py_ssize_t size)
+{
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    if (PyByteArray_Resize(out, size) < 0) {
+        PyErr_Clear();
+    }
+    PyErr_Restore(type, value, traceback);
+}
+
+PyObject *
+datetime_isoformat_many(PyObject *datetimes, PyObject *sep, int timespec,
+                        PyObject *end, PyObject *out)
+{
+    isoformat_options options = {"T", 1, timespec};
+    if (sep != NULL) {
+        if (!PyUnicode_Check(sep) || PyUnicode_GetLength(sep) != 1) {
+            PyErr_SetString(PyExc_TypeError,
+                            "isoformat_many: sep must be a single character");
+            return NULL;
+        }
+        options.sep = PyUnicode_AsUTF8AndSize(sep, &options.sep_len);
+        if (options.sep == NULL) {
+            return NULL;
+        }
+    }
+
+    const char *end_utf8 = "\n";
+    Py_ssize_t end_len = 1;
+    int ascii_end = 1;
+    if (end != NULL) {
+        if (!PyUnicode_Check(end)) {
+            PyErr_Format(PyExc_TypeError,
+                         "isoformat_many: end must be a str, not %.200s",
+                         Py_TYPE(end)->tp_name);
+            return NULL;
+        }
+        end_utf8 = PyUnicode_AsUTF8AndSize(end, &end_len);
+        if (end_utf8 == NULL) {
+            return NULL;
+        }
+        ascii_end = end_len == PyUnicode_GET_LENGTH(end);
+    }
+    const int ascii = options.sep_len == 1 && ascii_end;
+
+    PyObject *seq = PySequence_Fast(
+        datetimes, "isoformat_many: argument must be iterable");
+    if (seq == NULL) {
+        return NULL;
+    }
+    const Py_ssize_t len = PySequence_Fast_GET_SIZE(seq);
+
+    PyObject *buffer;
+    if (out != NULL) {
+        buffer = out;
+        Py_INCREF(buffer);
+    }
+    else {
+        buffer = PyByteArray_FromStringAndSize(NULL, 0);
+        if (buffer == NULL) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+
+    // Room for the longest string of every datetime, trimmed at the end
+    const Py_ssize_t start = PyByteArray_GET_SIZE(buffer);
+    const Py_ssize_t max_item_len =
+        DATETIME_MAX_LENGTH + SEP_MAX_LENGTH + UTC_OFFSET_MAX_LENGTH + end_len;
+    if (len > (PY_SSIZE_T_MAX - start) / max_item_len) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    const Py_ssize_t reserved = start + len * max_item_len;
+    if (PyByteArray_Resize(buffer, reserved) < 0) {
+        goto error;
+    }
+
+    Py_ssize_t pos = start;
+    for (Py_ssize_t i = 0; i < len; ++i) {
+        if (i >= PySequence_Fast_GET_SIZE(seq)) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "isoformat_many: sequence changed size during "
+                            "iteration");
+            goto error;
+        }
+
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        if (!PyDateTime_Check(item)) {
+            PyErr_Format(PyExc_TypeError,
+                         "isoformat_many: expected a datetime, not %.200s",
+                         Py_TYPE(item)->tp_name);
+            goto error;
+        }
+
+        // Formatted on the stack first, since tzinfo.utcoffset() may run
+        // arbitrary code, including code that resizes `out`
+        char item_buffer[DATETIME_MAX_LENGTH + SEP_MAX_LENGTH +
+                         UTC_OFFSET_MAX_LENGTH];
+        Py_INCREF(item);
+        char *item_end = write_datetime(item_buffer, item, &options);
+        Py_DECREF(item);
+        if (item_end == NULL) {
+            goto error;
+        }
+        if (PyByteArray_GET_SIZE(buffer) != reserved) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "isoformat_many: out changed size during "
+                            "iteration");
+            goto error;
+        }
+
+        char *p = PyByteArray_AS_STRING(buffer) + pos;
+        memcpy(p, item_buffer, item_end - item_buffer);
+        p += item_end - item_buffer;
+        memcpy(p, end_utf8, end_len);
+        pos += (item_end - item_buffer) + end_len;
+    }
+    Py_DECREF(seq);
+
+    if (PyByteArray_Resize(buffer, pos) < 0) {
+        Py_DECREF(buffer);
+        return NULL;
+    }
+    if (out != NULL) {
+        return buffer;
+    }
+
+    PyObject *result;
+    if (ascii) {
+        result = PyUnicode_New(pos, 127);
+        if (result != NULL) {
+            memcpy(PyUnicode_1BYTE_DATA(result), PyByteArray_AS_STRING(buffer),
+                   pos);
+        }
+    }
+    else {
+        result =
+            PyUnicode_DecodeUTF8(PyByteArray_AS_STRING(buffer), pos, NULL);
+    }
+    Py_DECREF(buffer);
+    return result;
+
+error:
+    if (out != NULL) {
+        truncate_out(out, start);
+    }
+    Py_DECREF(buffer);
+    Py_DECREF(seq);
+    return NULL;
+}
+
+int
+initialize_isoformat_code(void)
+{
+    PyDateTime_IMPORT;
+    return PyDateTimeAPI != NULL ? 0 : -1;
+}
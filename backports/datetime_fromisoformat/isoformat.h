@@ -0,0 +1,34 @@
+#ifndef ISOFORMAT_H
+#define ISOFORMAT_H
+
+#include <Python.h>
+
+/* The timespec argument of datetime.isoformat */
+enum {
+    TIMESPEC_AUTO = 0,
+    TIMESPEC_HOURS,
+    TIMESPEC_MINUTES,
+    TIMESPEC_SECONDS,
+    TIMESPEC_MILLISECONDS,
+    TIMESPEC_MICROSECONDS,
+};
+
+/* Return the TIMESPEC_* value named by `timespec`, or -1 with an exception
+ * set.
+ */
+int
+get_timespec(PyObject *timespec);
+
+/* Write dt.isoformat(sep, timespec) + end for each datetime of an iterable,
+ * UTF-8 encoded, at the end of the bytearray `out` (and return it), or into
+ * a new str if `out` is NULL. `sep` must be a single character; it is 'T'
+ * if NULL, and `end` is '\n' if NULL.
+ */
+PyObject *
+datetime_isoformat_many(PyObject *datetimes, PyObject *sep, int timespec,
+                        PyObject *end, PyObject *out);
+
+int
+initialize_isoformat_code(void);
+
+#endif
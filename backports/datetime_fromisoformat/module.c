@@ -2,42 +2,897 @@
 #include <datetime.h>
 
 #include "_datetimemodule.h"
+#include "isoformat.h"
 #include "timezone.h"
 
+/* The functions below take a few positional arguments followed by keyword-only
+ * options. With METH_FASTCALL, their arguments are unpacked without building
+ * a tuple or a dict, so that options add little to the cost of a call.
+ */
+#define MAX_KEYWORDS 5
+
+typedef struct {
+    const char *name;
+    const char *const *keywords;  // NULL-terminated
+    int required;                 // The first `required` arguments must be
+    int max_positional;           // given, and at most `max_positional` of
+                                  // them by position
+    PyObject *interned[MAX_KEYWORDS];  // The keywords, created on first use
+} arg_parser;
+
+/* Return the index of the keyword `key`, -1 if there is none, or -2 with an
+ * exception set.
+ */
+static int
+find_keyword(arg_parser *parser, PyObject *key)
+{
+    int i;
+
+    if (parser->interned[0] == NULL) {
+        // Only publish them once they all exist, since interned[0] tells
+        // whether they do
+        PyObject *interned[MAX_KEYWORDS];
+        for (i = 0; parser->keywords[i] != NULL; ++i) {
+            interned[i] = PyUnicode_InternFromString(parser->keywords[i]);
+            if (interned[i] == NULL) {
+                while (--i >= 0) {
+                    Py_DECREF(interned[i]);
+                }
+                return -2;
+            }
+        }
+        for (i = 0; parser->keywords[i] != NULL; ++i) {
+            parser->interned[i] = interned[i];
+        }
+    }
+
+    // Keywords written at call sites are interned, so they are usually the
+    // same objects as ours
+    for (i = 0; parser->keywords[i] != NULL; ++i) {
+        if (parser->interned[i] == key) {
+            return i;
+        }
+    }
+    for (i = 0; parser->keywords[i] != NULL; ++i) {
+        if (PyUnicode_Compare(parser->interned[i], key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int
+set_keyword_arg(arg_parser *parser, PyObject *key, PyObject *value,
+                Py_ssize_t nargs, PyObject **values)
+{
+    const int i = find_keyword(parser, key);
+    if (i == -2) {
+        return -1;
+    }
+    if (i == -1) {
+        PyErr_Format(PyExc_TypeError,
+                     "%s() got an unexpected keyword argument '%U'",
+                     parser->name, key);
+        return -1;
+    }
+
+    if (values[i] != NULL) {
+        if (i < nargs) {
+            PyErr_Format(PyExc_TypeError,
+                         "argument for %s() given by name ('%s') and "
+                         "position (%d)",
+                         parser->name, parser->keywords[i], i + 1);
+        }
+        else {
+            PyErr_Format(PyExc_TypeError,
+                         "%s() got multiple values for argument '%s'",
+                         parser->name, parser->keywords[i]);
+        }
+        return -1;
+    }
+    values[i] = value;
+    return 0;
+}
+
+static int
+check_positional_args(const arg_parser *parser, Py_ssize_t nargs)
+{
+    if (nargs <= parser->max_positional) {
+        return 0;
+    }
+    PyErr_Format(PyExc_TypeError,
+                 "%s() takes %s %d positional argument%s (%zd given)",
+                 parser->name,
+                 parser->max_positional == parser->required ? "exactly"
+                                                            : "at most",
+                 parser->max_positional,
+                 parser->max_positional == 1 ? "" : "s", nargs);
+    return -1;
+}
+
+static int
+check_required_args(const arg_parser *parser, PyObject **values)
+{
+    for (int i = 0; i < parser->required; ++i) {
+        if (values[i] == NULL) {
+            PyErr_Format(PyExc_TypeError,
+                         "%s() missing required argument '%s' (pos %d)",
+                         parser->name, parser->keywords[i], i + 1);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Store the arguments into `values`, which has an item (initialized to NULL)
+ * for each keyword. Those of the arguments that aren't given are left NULL.
+ */
+#if PY_VERSION_HEX >= 0x03070000
+#define KEYWORD_ARGS_PARAMS \
+    PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+#define KEYWORD_ARGS args, nargs, kwnames
+#define KEYWORD_ARGS_FLAGS (METH_FASTCALL | METH_KEYWORDS)
+
+static int
+unpack_args(arg_parser *parser, PyObject *const *args, Py_ssize_t nargs,
+            PyObject *kwnames, PyObject **values)
+{
+    if (check_positional_args(parser, nargs) < 0) {
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < nargs; ++i) {
+        values[i] = args[i];
+    }
+
+    if (kwnames != NULL) {
+        for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(kwnames); ++i) {
+            if (set_keyword_arg(parser, PyTuple_GET_ITEM(kwnames, i),
+                                args[nargs + i], nargs, values) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    return check_required_args(parser, values);
+}
+#else
+#define KEYWORD_ARGS_PARAMS PyObject *args, PyObject *kwargs
+#define KEYWORD_ARGS args, kwargs
+#define KEYWORD_ARGS_FLAGS (METH_VARARGS | METH_KEYWORDS)
+
+static int
+unpack_args(arg_parser *parser, PyObject *args, PyObject *kwargs,
+            PyObject **values)
+{
+    const Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+    if (check_positional_args(parser, nargs) < 0) {
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < nargs; ++i) {
+        values[i] = PyTuple_GET_ITEM(args, i);
+    }
+
+    if (kwargs != NULL) {
+        Py_ssize_t pos = 0;
+        PyObject *key, *value;
+        while (PyDict_Next(kwargs, &pos, &key, &value)) {
+            if (set_keyword_arg(parser, key, value, nargs, values) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    return check_required_args(parser, values);
+}
+#endif
+
+/* Converters for the optional arguments, which leave `*value` unchanged if
+ * the argument wasn't given.
+ */
+static int
+ssize_arg(PyObject *arg, Py_ssize_t *value)
+{
+    if (arg != NULL) {
+        Py_ssize_t result = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+        if (result == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+        *value = result;
+    }
+    return 0;
+}
+
+static int
+int_arg(PyObject *arg, int *value)
+{
+    Py_ssize_t result = *value;
+    if (ssize_arg(arg, &result) < 0) {
+        return -1;
+    }
+    if (result > INT_MAX || result < INT_MIN) {
+        PyErr_SetString(PyExc_OverflowError,
+                        result > INT_MAX
+                            ? "signed integer is greater than maximum"
+                            : "signed integer is less than minimum");
+        return -1;
+    }
+    *value = (int)result;
+    return 0;
+}
+
+static int
+bool_arg(PyObject *arg, int *value)
+{
+    if (arg != NULL) {
+        int result = PyObject_IsTrue(arg);
+        if (result < 0) {
+            return -1;
+        }
+        *value = result;
+    }
+    return 0;
+}
+
+/* unit='us' (the default) or 'ns' */
+static int
+unit_arg(PyObject *arg, int *nanoseconds)
+{
+    *nanoseconds = 0;
+    if (arg == NULL) {
+        return 0;
+    }
+    if (!PyUnicode_Check(arg)) {
+        PyErr_Format(PyExc_TypeError, "unit must be a str, not %.200s",
+                     Py_TYPE(arg)->tp_name);
+        return -1;
+    }
+    if (PyUnicode_CompareWithASCIIString(arg, "us") == 0) {
+        return 0;
+    }
+    if (PyUnicode_CompareWithASCIIString(arg, "ns") == 0) {
+        *nanoseconds = 1;
+        return 0;
+    }
+    PyErr_Format(PyExc_ValueError, "unit must be 'us' or 'ns', not %R", arg);
+    return -1;
+}
+
+/* The single-string functions take (date_string, *, errors, default), or
+ * time_string for time_fromisoformat, as in the standard library.
+ */
+static const char *const single_keywords[] = {"date_string", "errors",
+                                              "default", NULL};
+static const char *const time_keywords[] = {"time_string", "errors",
+                                            "default", NULL};
+
+static int
+parse_single_args(arg_parser *parser, KEYWORD_ARGS_PARAMS,
+                  PyObject **dtstr, PyObject **invalid)
+{
+    PyObject *values[3] = {NULL, NULL, NULL};
+
+    // The common case, which costs no more than with METH_O
+#if PY_VERSION_HEX >= 0x03070000
+    if (nargs == 1 && kwnames == NULL) {
+        *dtstr = args[0];
+        *invalid = NULL;
+        return 0;
+    }
+#else
+    if (PyTuple_GET_SIZE(args) == 1 && kwargs == NULL) {
+        *dtstr = PyTuple_GET_ITEM(args, 0);
+        *invalid = NULL;
+        return 0;
+    }
+#endif
+
+    if (unpack_args(parser, KEYWORD_ARGS, values) < 0) {
+        return -1;
+    }
+    *dtstr = values[0];
+    return get_invalid_result(values[1], values[2], invalid);
+}
+
+static PyObject *
+fromisoformat_date(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static arg_parser parser = {"date_fromisoformat", single_keywords, 1, 1};
+    PyObject *dtstr, *invalid;
+    if (parse_single_args(&parser, KEYWORD_ARGS, &dtstr, &invalid) < 0) {
+        return NULL;
+    }
+
+    return date_fromisoformat_any(dtstr, invalid);
+}
+
+static PyObject *
+fromisoformat_time(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static arg_parser parser = {"time_fromisoformat", time_keywords, 1, 1};
+    PyObject *dtstr, *invalid;
+    if (parse_single_args(&parser, KEYWORD_ARGS, &dtstr, &invalid) < 0) {
+        return NULL;
+    }
+
+    return time_fromisoformat_any(dtstr, invalid);
+}
+
+static PyObject *
+fromisoformat_datetime(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static arg_parser parser = {"datetime_fromisoformat",
+                                single_keywords, 1, 1};
+    PyObject *dtstr, *invalid;
+    if (parse_single_args(&parser, KEYWORD_ARGS, &dtstr, &invalid) < 0) {
+        return NULL;
+    }
+
+    return datetime_fromisoformat_any(dtstr, invalid);
+}
+
+#if PY_VERSION_HEX < 0x030B0000
+/* The stdlib methods, which patch_fromisoformat replaces, only accept str.
+ * Like them, these are classmethods, which return instances of the subclasses
+ * they are called on.
+ */
+static PyObject *
+tzinfo_or_none(PyObject *obj)
+{
+    if (PyDateTime_Check(obj)) {
+        PyDateTime_DateTime *dt = (PyDateTime_DateTime *)obj;
+        return dt->hastzinfo ? dt->tzinfo : Py_None;
+    }
+    PyDateTime_Time *t = (PyDateTime_Time *)obj;
+    return t->hastzinfo ? t->tzinfo : Py_None;
+}
+
+static PyObject *
+fromisoformat_date_cls(PyObject *cls, PyObject *dtstr)
+{
+    PyObject *result = date_fromisoformat(dtstr);
+    if (result == NULL || cls == (PyObject *)PyDateTimeAPI->DateType) {
+        return result;
+    }
+
+    PyObject *instance = PyObject_CallFunction(
+        cls, "iii", PyDateTime_GET_YEAR(result), PyDateTime_GET_MONTH(result),
+        PyDateTime_GET_DAY(result));
+    Py_DECREF(result);
+    return instance;
+}
+
+static PyObject *
+fromisoformat_time_cls(PyObject *cls, PyObject *tstr)
+{
+    PyObject *result = time_fromisoformat(tstr);
+    if (result == NULL || cls == (PyObject *)PyDateTimeAPI->TimeType) {
+        return result;
+    }
+
+    PyObject *instance = PyObject_CallFunction(
+        cls, "iiiiO", PyDateTime_TIME_GET_HOUR(result),
+        PyDateTime_TIME_GET_MINUTE(result),
+        PyDateTime_TIME_GET_SECOND(result),
+        PyDateTime_TIME_GET_MICROSECOND(result), tzinfo_or_none(result));
+    Py_DECREF(result);
+    return instance;
+}
+
+static PyObject *
+fromisoformat_datetime_cls(PyObject *cls, PyObject *dtstr)
+{
+    PyObject *result = datetime_fromisoformat(dtstr);
+    if (result == NULL || cls == (PyObject *)PyDateTimeAPI->DateTimeType) {
+        return result;
+    }
+
+    PyObject *instance = PyObject_CallFunction(
+        cls, "iiiiiiiO", PyDateTime_GET_YEAR(result),
+        PyDateTime_GET_MONTH(result), PyDateTime_GET_DAY(result),
+        PyDateTime_DATE_GET_HOUR(result), PyDateTime_DATE_GET_MINUTE(result),
+        PyDateTime_DATE_GET_SECOND(result),
+        PyDateTime_DATE_GET_MICROSECOND(result), tzinfo_or_none(result));
+    Py_DECREF(result);
+    return instance;
+}
+
+static PyMethodDef fromisoformat_date_def = {
+    "fromisoformat", fromisoformat_date_cls, METH_O | METH_CLASS,
+    "Construct a date from a string in ISO 8601 format"};
+
+static PyMethodDef fromisoformat_time_def = {
+    "fromisoformat", fromisoformat_time_cls, METH_O | METH_CLASS,
+    "Construct a time from a string in ISO 8601 format"};
+
+static PyMethodDef fromisoformat_datetime_def = {
+    "fromisoformat", fromisoformat_datetime_cls, METH_O | METH_CLASS,
+    "Construct a datetime from a string in ISO 8601 format"};
+
+static int
+install_classmethod(PyTypeObject *type, PyMethodDef *def)
+{
+    PyObject *method = PyDescr_NewClassMethod(type, def);
+    if (method == NULL) {
+        return -1;
+    }
+
+    // The datetime types are immutable, so their dict is set directly
+    const int rv = PyDict_SetItemString(type->tp_dict, def->ml_name, method);
+    Py_DECREF(method);
+    if (rv < 0) {
+        return -1;
+    }
+
+    // Invalidate the method caches of the type and of its subclasses
+    PyType_Modified(type);
+    return 0;
+}
+#endif
+
+static PyObject *
+fromisoformat_patch(PyObject *self, PyObject *unused)
+{
+    // Since 3.11, the stdlib methods accept the same strings
+#if PY_VERSION_HEX < 0x030B0000
+    if (install_classmethod(PyDateTimeAPI->DateType, &fromisoformat_date_def) <
+            0 ||
+        install_classmethod(PyDateTimeAPI->TimeType, &fromisoformat_time_def) <
+            0 ||
+        install_classmethod(PyDateTimeAPI->DateTimeType,
+                            &fromisoformat_datetime_def) < 0) {
+        return NULL;
+    }
+#endif
+    Py_RETURN_NONE;
+}
+
+static const char *const many_keywords[] = {"iterable", "threads", "errors",
+                                            "default", NULL};
+
+static PyObject *
+fromisoformat_many_args(arg_parser *parser, KEYWORD_ARGS_PARAMS,
+                        PyObject *(*parse_many)(PyObject *, int, PyObject *))
+{
+    PyObject *values[4] = {NULL, NULL, NULL, NULL};
+    int threads = 1;
+    PyObject *invalid;
+
+    if (unpack_args(parser, KEYWORD_ARGS, values) < 0 ||
+        int_arg(values[1], &threads) < 0 ||
+        get_invalid_result(values[2], values[3], &invalid) < 0) {
+        return NULL;
+    }
+
+    return parse_many(values[0], threads, invalid);
+}
+
 static PyObject *
-fromisoformat_date(PyObject *self, PyObject *dtstr)
+fromisoformat_date_many(PyObject *self, KEYWORD_ARGS_PARAMS)
 {
-    PyObject *obj;
-    obj = date_fromisoformat(dtstr);
-    return obj;
+    static arg_parser parser = {"date_fromisoformat_many",
+                                many_keywords, 1, 1};
+    return fromisoformat_many_args(&parser, KEYWORD_ARGS,
+                                   date_fromisoformat_many);
 }
 
 static PyObject *
-fromisoformat_time(PyObject *self, PyObject *dtstr)
+fromisoformat_time_many(PyObject *self, KEYWORD_ARGS_PARAMS)
 {
-    PyObject *obj;
-    obj = time_fromisoformat(dtstr);
-    return obj;
+    static arg_parser parser = {"time_fromisoformat_many",
+                                many_keywords, 1, 1};
+    return fromisoformat_many_args(&parser, KEYWORD_ARGS,
+                                   time_fromisoformat_many);
 }
 
 static PyObject *
-fromisoformat_datetime(PyObject *self, PyObject *dtstr)
+fromisoformat_datetime_many(PyObject *self, KEYWORD_ARGS_PARAMS)
 {
-    PyObject *obj;
-    obj = datetime_fromisoformat(dtstr);
-    return obj;
+    static arg_parser parser = {"datetime_fromisoformat_many",
+                                many_keywords, 1, 1};
+    return fromisoformat_many_args(&parser, KEYWORD_ARGS,
+                                   datetime_fromisoformat_many);
+}
+
+static PyObject *
+fromisoformat_fields(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static arg_parser parser = {"parse_isoformat_fields", single_keywords,
+                                1, 1};
+    PyObject *dtstr, *invalid;
+    if (parse_single_args(&parser, KEYWORD_ARGS, &dtstr, &invalid) < 0) {
+        return NULL;
+    }
+
+    return parse_isoformat_fields(dtstr, invalid);
+}
+
+static PyObject *
+validate_date(PyObject *self, PyObject *dtstr)
+{
+    return is_isoformat_date(dtstr);
+}
+
+static PyObject *
+validate_time(PyObject *self, PyObject *tstr)
+{
+    return is_isoformat_time(tstr);
+}
+
+static PyObject *
+validate_datetime(PyObject *self, PyObject *dtstr)
+{
+    return is_isoformat_datetime(dtstr);
+}
+
+static const char *const validate_many_keywords[] = {"strings", "validity",
+                                                     "threads", NULL};
+
+static PyObject *
+validate_many_args(arg_parser *parser, KEYWORD_ARGS_PARAMS,
+                   PyObject *(*validate_many)(PyObject *, PyObject *, int))
+{
+    PyObject *values[3] = {NULL, NULL, NULL};
+    int threads = 1;
+
+    if (unpack_args(parser, KEYWORD_ARGS, values) < 0 ||
+        int_arg(values[2], &threads) < 0) {
+        return NULL;
+    }
+
+    return validate_many(values[0], values[1] != NULL ? values[1] : Py_None,
+                         threads);
+}
+
+static PyObject *
+validate_date_many(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static arg_parser parser = {"is_isoformat_date_many",
+                                validate_many_keywords, 1, 2};
+    return validate_many_args(&parser, KEYWORD_ARGS, is_isoformat_date_many);
+}
+
+static PyObject *
+validate_time_many(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static arg_parser parser = {"is_isoformat_time_many",
+                                validate_many_keywords, 1, 2};
+    return validate_many_args(&parser, KEYWORD_ARGS, is_isoformat_time_many);
+}
+
+static PyObject *
+validate_datetime_many(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static arg_parser parser = {"is_isoformat_datetime_many",
+                                validate_many_keywords, 1, 2};
+    return validate_many_args(&parser, KEYWORD_ARGS,
+                              is_isoformat_datetime_many);
+}
+
+static PyObject *
+fromisoformat_datetime_to_epoch(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static const char *const keywords[] = {"date_string", "unit", "errors",
+                                           "default", NULL};
+    static arg_parser parser = {"datetime_fromisoformat_to_epoch",
+                                keywords, 1, 2};
+    PyObject *values[4] = {NULL, NULL, NULL, NULL};
+    int nanoseconds;
+    PyObject *invalid;
+
+    if (unpack_args(&parser, KEYWORD_ARGS, values) < 0 ||
+        unit_arg(values[1], &nanoseconds) < 0 ||
+        get_invalid_result(values[2], values[3], &invalid) < 0) {
+        return NULL;
+    }
+
+    return datetime_fromisoformat_to_epoch(values[0], nanoseconds, invalid);
+}
+
+static PyObject *
+fromisoformat_prefix(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static const char *const keywords[] = {"date_string", "pos", "errors",
+                                           "default", NULL};
+    static arg_parser parser = {"parse_isoformat_prefix", keywords, 1, 2};
+    PyObject *values[4] = {NULL, NULL, NULL, NULL};
+    Py_ssize_t pos = 0;
+    PyObject *invalid;
+
+    if (unpack_args(&parser, KEYWORD_ARGS, values) < 0 ||
+        ssize_arg(values[1], &pos) < 0 ||
+        get_invalid_result(values[2], values[3], &invalid) < 0) {
+        return NULL;
+    }
+
+    return parse_isoformat_prefix(values[0], pos, invalid);
+}
+
+static PyObject *
+fromisoformat_date_to_days(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static const char *const keywords[] = {"strings", "out",     "validity",
+                                           "ordinal", "threads", NULL};
+    static arg_parser parser = {"date_fromisoformat_to_days", keywords, 1, 4};
+    PyObject *values[5] = {NULL, NULL, NULL, NULL, NULL};
+    int ordinal = 0;
+    int threads = 1;
+
+    if (unpack_args(&parser, KEYWORD_ARGS, values) < 0 ||
+        bool_arg(values[3], &ordinal) < 0 ||
+        int_arg(values[4], &threads) < 0) {
+        return NULL;
+    }
+
+    return date_fromisoformat_to_days(
+        values[0], values[1] != NULL ? values[1] : Py_None,
+        values[2] != NULL ? values[2] : Py_None, ordinal, threads);
+}
+
+static PyObject *
+fromisoformat_datetime_to_epoch_arrow(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static const char *const keywords[] = {"array",    "unit",    "out",
+                                           "validity", "threads", NULL};
+    static arg_parser parser = {"datetime_fromisoformat_to_epoch_arrow",
+                                keywords, 1, 4};
+    PyObject *values[5] = {NULL, NULL, NULL, NULL, NULL};
+    int nanoseconds;
+    int threads = 1;
+
+    if (unpack_args(&parser, KEYWORD_ARGS, values) < 0 ||
+        unit_arg(values[1], &nanoseconds) < 0 ||
+        int_arg(values[4], &threads) < 0) {
+        return NULL;
+    }
+
+    return datetime_fromisoformat_to_epoch_arrow(
+        values[0], nanoseconds, values[2] != NULL ? values[2] : Py_None,
+        values[3] != NULL ? values[3] : Py_None, threads);
+}
+
+static PyObject *
+fromisoformat_datetime_lines(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static const char *const keywords[] = {"file",   "chunk_size", "threads",
+                                           "errors", "default",    NULL};
+    static arg_parser parser = {"datetime_fromisoformat_lines",
+                                keywords, 1, 1};
+    PyObject *values[5] = {NULL, NULL, NULL, NULL, NULL};
+    Py_ssize_t chunk_size = 65536;
+    int threads = 1;
+    PyObject *invalid;
+
+    if (unpack_args(&parser, KEYWORD_ARGS, values) < 0 ||
+        ssize_arg(values[1], &chunk_size) < 0 ||
+        int_arg(values[2], &threads) < 0 ||
+        get_invalid_result(values[3], values[4], &invalid) < 0) {
+        return NULL;
+    }
+
+    return datetime_fromisoformat_lines(values[0], chunk_size, threads,
+                                        invalid);
+}
+
+static PyObject *
+isoformat_many(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static const char *const keywords[] = {"datetimes", "sep", "timespec",
+                                           "out", "end", NULL};
+    static arg_parser parser = {"isoformat_many", keywords, 1, 3};
+    PyObject *values[5] = {NULL, NULL, NULL, NULL, NULL};
+    PyObject *out = NULL;
+    int timespec = TIMESPEC_AUTO;
+
+    if (unpack_args(&parser, KEYWORD_ARGS, values) < 0 ||
+        (values[2] != NULL && (timespec = get_timespec(values[2])) < 0)) {
+        return NULL;
+    }
+    if (values[3] != NULL && values[3] != Py_None) {
+        if (!PyByteArray_Check(values[3])) {
+            PyErr_Format(PyExc_TypeError,
+                         "isoformat_many: out must be a bytearray, not "
+                         "%.200s",
+                         Py_TYPE(values[3])->tp_name);
+            return NULL;
+        }
+        out = values[3];
+    }
+
+    return datetime_isoformat_many(values[0], values[1], timespec, values[4],
+                                   out);
+}
+
+static PyObject *
+timezone_mode_get(PyObject *self, PyObject *unused)
+{
+    return get_timezone_mode();
+}
+
+static PyObject *
+timezone_mode_set(PyObject *self, PyObject *mode)
+{
+    PyObject *result = set_timezone_mode(mode);
+    if (result != NULL) {
+        // Cached datetimes may have the tzinfo of the previous mode
+        clear_result_cache();
+    }
+    return result;
+}
+
+static PyObject *
+result_cache_set(PyObject *self, KEYWORD_ARGS_PARAMS)
+{
+    static const char *const keywords[] = {"maxsize", "datetimes", NULL};
+    static arg_parser parser = {"set_result_cache", keywords, 1, 1};
+    PyObject *values[2] = {NULL, NULL};
+    Py_ssize_t maxsize = 0;
+    int datetimes = 0;
+
+    if (unpack_args(&parser, KEYWORD_ARGS, values) < 0 ||
+        ssize_arg(values[0], &maxsize) < 0 ||
+        bool_arg(values[1], &datetimes) < 0) {
+        return NULL;
+    }
+
+    return set_result_cache(maxsize, datetimes);
+}
+
+static PyObject *
+result_cache_info(PyObject *self, PyObject *unused)
+{
+    return get_result_cache_info();
 }
 
 static PyMethodDef FromISOFormatMethods[] = {
-    {"date_fromisoformat", fromisoformat_date, METH_O,
+    {"date_fromisoformat", (PyCFunction)(void (*)(void))fromisoformat_date,
+     KEYWORD_ARGS_FLAGS,
      "Return a date corresponding to a date_string in one of the formats "
-     "emitted by date.isoformat()"},
-    {"time_fromisoformat", fromisoformat_time, METH_O,
+     "emitted by date.isoformat(). date_string may be a str or a UTF-8 "
+     "encoded bytes-like object. With errors='coerce' (or 'default'), None "
+     "(or default) is returned for invalid strings instead of raising "
+     "ValueError"},
+    {"time_fromisoformat", (PyCFunction)(void (*)(void))fromisoformat_time,
+     KEYWORD_ARGS_FLAGS,
      "Return a time corresponding to a date_string in one of the formats "
-     "emitted by time.isoformat()"},
-    {"datetime_fromisoformat", fromisoformat_datetime, METH_O,
+     "emitted by time.isoformat(). date_string may be a str or a UTF-8 "
+     "encoded bytes-like object. errors and default are as for "
+     "date_fromisoformat"},
+    {"datetime_fromisoformat", (PyCFunction)(void (*)(void))fromisoformat_datetime,
+     KEYWORD_ARGS_FLAGS,
      "Return a datetime corresponding to a date_string in one of the formats "
-     "emitted by datetime.isoformat()"},
+     "emitted by datetime.isoformat(). date_string may be a str or a UTF-8 "
+     "encoded bytes-like object. errors and default are as for "
+     "date_fromisoformat"},
+    {"patch_fromisoformat", fromisoformat_patch, METH_NOARGS,
+     "Replace the fromisoformat classmethods of date, time and datetime with "
+     "classmethods using this module's parser, before Python 3.11 (whose "
+     "own accept the same strings)"},
+    {"date_fromisoformat_many",
+     (PyCFunction)(void (*)(void))fromisoformat_date_many,
+     KEYWORD_ARGS_FLAGS,
+     "Return a list of dates, one for each string in an iterable, as "
+     "date_fromisoformat would (including errors and default). With "
+     "threads > 1, the strings are parsed on up to that many threads, "
+     "without the GIL"},
+    {"time_fromisoformat_many",
+     (PyCFunction)(void (*)(void))fromisoformat_time_many,
+     KEYWORD_ARGS_FLAGS,
+     "Return a list of times, one for each string in an iterable, as "
+     "time_fromisoformat would (including errors and default). With "
+     "threads > 1, the strings are parsed on up to that many threads, "
+     "without the GIL"},
+    {"datetime_fromisoformat_many",
+     (PyCFunction)(void (*)(void))fromisoformat_datetime_many,
+     KEYWORD_ARGS_FLAGS,
+     "Return a list of datetimes, one for each string in an iterable, as "
+     "datetime_fromisoformat would (including errors and default). With "
+     "threads > 1, the strings are parsed on up to that many threads, "
+     "without the GIL"},
+    {"parse_isoformat_fields",
+     (PyCFunction)(void (*)(void))fromisoformat_fields, KEYWORD_ARGS_FLAGS,
+     "Return an IsoformatFields (year, month, day, hour, minute, second, "
+     "microsecond, offset_seconds, offset_microseconds, has_offset) of a "
+     "date_string accepted by datetime_fromisoformat, without creating a "
+     "datetime. errors and default are as for datetime_fromisoformat"},
+    {"is_isoformat_date", validate_date, METH_O,
+     "Return whether date_string (a str or a UTF-8 encoded bytes-like "
+     "object) is a string date_fromisoformat accepts, without creating a "
+     "date or raising ValueError"},
+    {"is_isoformat_time", validate_time, METH_O,
+     "Return whether time_string (a str or a UTF-8 encoded bytes-like "
+     "object) is a string time_fromisoformat accepts, without creating a "
+     "time or raising ValueError"},
+    {"is_isoformat_datetime", validate_datetime, METH_O,
+     "Return whether date_string (a str or a UTF-8 encoded bytes-like "
+     "object) is a string datetime_fromisoformat accepts, without creating "
+     "a datetime or raising ValueError"},
+    {"is_isoformat_date_many",
+     (PyCFunction)(void (*)(void))validate_date_many, KEYWORD_ARGS_FLAGS,
+     "Check every string of a sequence as is_isoformat_date would. validity "
+     "(a writable buffer, by default a new bytearray) is set to a bitmap, "
+     "least significant bit first, of the valid strings, None being "
+     "invalid. The strings are checked on up to threads threads (1 by "
+     "default), without the GIL. Return validity"},
+    {"is_isoformat_time_many",
+     (PyCFunction)(void (*)(void))validate_time_many, KEYWORD_ARGS_FLAGS,
+     "Check every string of a sequence as is_isoformat_time would, into a "
+     "bitmap as is_isoformat_date_many does. Return validity"},
+    {"is_isoformat_datetime_many",
+     (PyCFunction)(void (*)(void))validate_datetime_many, KEYWORD_ARGS_FLAGS,
+     "Check every string of a sequence as is_isoformat_datetime would, into "
+     "a bitmap as is_isoformat_date_many does. Return validity"},
+    {"datetime_fromisoformat_to_epoch",
+     (PyCFunction)(void (*)(void))fromisoformat_datetime_to_epoch,
+     KEYWORD_ARGS_FLAGS,
+     "Return the number of microseconds (unit='us', the default) or "
+     "nanoseconds (unit='ns') since the Unix epoch of a date_string in one "
+     "of the formats emitted by datetime.isoformat(), without creating a "
+     "datetime. Naive datetimes are taken to be in UTC. errors and default "
+     "are as for datetime_fromisoformat"},
+    {"parse_isoformat_prefix",
+     (PyCFunction)(void (*)(void))fromisoformat_prefix,
+     KEYWORD_ARGS_FLAGS,
+     "Parse the longest prefix of date_string (a str or a UTF-8 encoded "
+     "bytes-like object) starting at index pos that datetime_fromisoformat "
+     "accepts, without slicing it. Return (datetime, end), where end is the "
+     "index just after the prefix. If there is no such prefix, errors and "
+     "default are as for datetime_fromisoformat"},
+    {"date_fromisoformat_to_days",
+     (PyCFunction)(void (*)(void))fromisoformat_date_to_days,
+     KEYWORD_ARGS_FLAGS,
+     "Parse a sequence of date strings into int32 days since the Unix epoch "
+     "(or proleptic Gregorian ordinals, if ordinal is true), without "
+     "creating dates. They are written into out (any writable buffer, by "
+     "default a new array.array('i')), and validity (a writable buffer, by "
+     "default a new bytearray) is set to a bitmap, least significant bit "
+     "first, of the valid strings. None and invalid strings are stored as 0 "
+     "and flagged as invalid. The strings are parsed on up to threads "
+     "threads (1 by default), without the GIL. Return (out, validity)"},
+    {"datetime_fromisoformat_to_epoch_arrow",
+     (PyCFunction)(void (*)(void))fromisoformat_datetime_to_epoch_arrow,
+     KEYWORD_ARGS_FLAGS,
+     "Parse an Arrow string or large_string array (any object with an "
+     "__arrow_c_array__ method) in place into int64 microseconds (unit='us', "
+     "the default) or nanoseconds (unit='ns') since the Unix epoch, as "
+     "datetime_fromisoformat_to_epoch would. They are written into out (any "
+     "writable buffer, by default a new array.array('q')), and validity (a "
+     "writable buffer, by default a new bytearray) is set to a bitmap, least "
+     "significant bit first, of the valid strings. Nulls, invalid strings and "
+     "nanoseconds that don't fit in 64 bits are stored as 0 and flagged as "
+     "invalid. The strings are parsed on up to threads threads (1 by "
+     "default). Return (out, validity)"},
+    {"datetime_fromisoformat_lines",
+     (PyCFunction)(void (*)(void))fromisoformat_datetime_lines,
+     KEYWORD_ARGS_FLAGS,
+     "Return an iterator over the lines of a file (a path or a file "
+     "descriptor), which is memory-mapped and parsed in place as "
+     "datetime_fromisoformat would. It yields lists of up to chunk_size "
+     "datetimes, scanning and parsing each chunk without the GIL (on up to "
+     "threads threads). Surrounding whitespace is ignored, and so are blank "
+     "lines. errors and default are as for datetime_fromisoformat"},
+    {"isoformat_many", (PyCFunction)(void (*)(void))isoformat_many,
+     KEYWORD_ARGS_FLAGS,
+     "Format each datetime of an iterable as datetime.isoformat(sep, "
+     "timespec) would, followed by end ('\\n' by default), into a single str. "
+     "If out (a bytearray) is given, the UTF-8 encoded strings are appended "
+     "to it instead, and it is returned. The offsets of FixedOffset tzinfos "
+     "are formatted without calling their utcoffset()"},
+    {"get_timezone_mode", timezone_mode_get, METH_NOARGS,
+     "Return the name of the current timezone mode"},
+    {"set_timezone_mode", timezone_mode_set, METH_O,
+     "Set which tzinfo type is returned for strings with a UTC offset: "
+     "'fixed_offset' (the default) returns FixedOffset instances, 'utc' "
+     "returns datetime.timezone.utc for zero offsets and FixedOffset "
+     "otherwise, 'timezone' returns datetime.timezone instances"},
+    {"set_result_cache", (PyCFunction)(void (*)(void))result_cache_set,
+     KEYWORD_ARGS_FLAGS,
+     "Share the results of date_fromisoformat (and of datetime_fromisoformat, "
+     "if datetimes is true) between calls with the same ASCII string, in a "
+     "cache of up to maxsize results. The cache starts disabled; maxsize=0 "
+     "disables it again. This also clears the cache and its statistics"},
+    {"get_result_cache_info", result_cache_info, METH_NOARGS,
+     "Return a dict with the hits, misses, maxsize and currsize of the "
+     "result cache, and whether it includes datetimes"},
     {NULL, NULL, 0, NULL}};
 
 static struct PyModuleDef moduledef = {
@@ -61,6 +916,11 @@ PyInit__datetime_fromisoformat(void)
     if (initialize_timezone_code(module) < 0)
         return NULL;
 
-    initialize_datetime_code();
+    if (initialize_datetime_code(module) < 0)
+        return NULL;
+
+    if (initialize_isoformat_code() < 0)
+        return NULL;
+
     return module;
 }
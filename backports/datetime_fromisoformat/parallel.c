@@ -0,0 +1,106 @@
+#include "parallel.h"
+
+#include <pythread.h>
+
+#ifndef PYTHREAD_INVALID_THREAD_ID
+#define PYTHREAD_INVALID_THREAD_ID ((unsigned long)-1)
+#endif
+
+/* Splitting fewer items than this between threads costs more than it saves */
+#define PARALLEL_MIN_ITEMS_PER_THREAD 4096
+
+typedef struct {
+    void (*func)(void *arg, Py_ssize_t start, Py_ssize_t end);
+    void *arg;
+    Py_ssize_t start;
+    Py_ssize_t end;
+    // Held by the calling thread until the worker is done
+    PyThread_type_lock done;
+} parallel_task;
+
+static void
+run_task(void *task_ptr)
+{
+    parallel_task *task = task_ptr;
+    task->func(task->arg, task->start, task->end);
+    PyThread_release_lock(task->done);
+}
+
+int
+parallel_for(Py_ssize_t len, int threads,
+             void (*func)(void *arg, Py_ssize_t start, Py_ssize_t end),
+             void *arg)
+{
+    const Py_ssize_t max_threads =
+        (len + PARALLEL_MIN_ITEMS_PER_THREAD - 1) /
+        PARALLEL_MIN_ITEMS_PER_THREAD;
+    if (threads > max_threads) {
+        threads = (int)max_threads;
+    }
+
+    if (threads <= 1) {
+        Py_BEGIN_ALLOW_THREADS
+        func(arg, 0, len);
+        Py_END_ALLOW_THREADS
+        return 0;
+    }
+
+    parallel_task *tasks = PyMem_Calloc(threads, sizeof(parallel_task));
+    if (tasks == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    Py_ssize_t chunk = (len + threads - 1) / threads;
+    chunk = (chunk + PARALLEL_ALIGNMENT - 1) / PARALLEL_ALIGNMENT *
+            PARALLEL_ALIGNMENT;
+
+    // tasks[0] runs on the calling thread, and the others on new threads
+    // (or on the calling thread too, if they can't be started).
+    for (int i = 0; i < threads; ++i) {
+        parallel_task *task = &tasks[i];
+        task->func = func;
+        task->arg = arg;
+        task->start = Py_MIN(i * chunk, len);
+        task->end = Py_MIN((i + 1) * chunk, len);
+
+        if (i == 0 || task->start == task->end) {
+            continue;
+        }
+
+        task->done = PyThread_allocate_lock();
+        if (task->done == NULL) {
+            continue;
+        }
+        PyThread_acquire_lock(task->done, WAIT_LOCK);
+        if (PyThread_start_new_thread(run_task, task) ==
+            PYTHREAD_INVALID_THREAD_ID) {
+            PyThread_release_lock(task->done);
+            PyThread_free_lock(task->done);
+            task->done = NULL;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (int i = 0; i < threads; ++i) {
+        parallel_task *task = &tasks[i];
+        if (task->done == NULL && task->start < task->end) {
+            func(arg, task->start, task->end);
+        }
+    }
+    for (int i = 0; i < threads; ++i) {
+        if (tasks[i].done != NULL) {
+            PyThread_acquire_lock(tasks[i].done, WAIT_LOCK);
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    for (int i = 0; i < threads; ++i) {
+        if (tasks[i].done != NULL) {
+            PyThread_release_lock(tasks[i].done);
+            PyThread_free_lock(tasks[i].done);
+        }
+    }
+    PyMem_Free(tasks);
+    return 0;
+}
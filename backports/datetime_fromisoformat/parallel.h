@@ -0,0 +1,22 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <Python.h>
+
+/* The ranges given to each thread start at multiples of this many items, so
+ * that threads never write to the same byte of a bitmap.
+ */
+#define PARALLEL_ALIGNMENT 64
+
+/* Call `func(arg, start, end)` over ranges covering [0, len), on up to
+ * `threads` threads (including the calling one). Must be called with the GIL
+ * held; it is released while `func` runs, so `func` must not use the Python
+ * C API. Return -1 (with an exception set) if the threads couldn't be set
+ * up, else 0.
+ */
+int
+parallel_for(Py_ssize_t len, int threads,
+             void (*func)(void *arg, Py_ssize_t start, Py_ssize_t end),
+             void *arg);
+
+#endif
@@ -0,0 +1,651 @@
+/* Parsers for the strings accepted by the fromisoformat methods.
+ *
+ * This file is a template, in the style of CPython's `Objects/stringlib`:
+ * _datetimemodule.c includes it once per code unit type, so that str objects
+ * can be parsed directly from their PyUnicode_DATA, whatever their kind.
+ * Before each inclusion, define:
+ *   - ISOFORMAT_CHAR: the code unit type
+ *   - ISOFORMAT(name): mangles `name` into a unique function name
+ *   - ISOFORMAT_UTF8: 1 if the code units are UTF-8 (ie. from a bytes-like
+ *     object), 0 if each code unit is a full code point.
+ *
+ * The functions never read at or past their end pointer, so they can be used
+ * on buffers that aren't NUL-terminated (eg. slices of a larger bytes-like
+ * object). Like CPython's, they treat a NUL character in the string as its
+ * end.
+ */
+
+static const ISOFORMAT_CHAR *
+ISOFORMAT(parse_digits)(const ISOFORMAT_CHAR *ptr, const ISOFORMAT_CHAR *end,
+                        int *var, size_t num_digits)
+{
+    size_t i = 0;
+    if ((size_t)(end - ptr) < num_digits) {
+        return NULL;
+    }
+
+    for (i = 0; i < num_digits; ++i) {
+        unsigned int tmp = (unsigned int)(*(ptr++) - '0');
+        if (tmp > 9) {
+            return NULL;
+        }
+        *var *= 10;
+        *var += (signed int)tmp;
+    }
+
+    return ptr;
+}
+
+/* The functions below parse the fixed-length strings generated by the
+ * isoformat() methods (with the default, "minutes" or "milliseconds"
+ * timespec) with one switch on their length and a few separator checks,
+ * instead of the general grammar. They return -1 for any other string, which
+ * must then be parsed by the general functions, and leave their outputs
+ * untouched in that case.
+ */
+
+/* Return the value of the `num_digits` digits at `ptr`, or -1. */
+static int
+ISOFORMAT(fixed_digits)(const ISOFORMAT_CHAR *ptr, size_t num_digits)
+{
+    unsigned int value = 0, invalid = 0;
+    for (size_t i = 0; i < num_digits; ++i) {
+        const unsigned int tmp = (unsigned int)(ptr[i] - '0');
+        invalid |= tmp > 9;
+        value = value * 10 + tmp;
+    }
+
+    return invalid ? -1 : (int)value;
+}
+
+static int
+ISOFORMAT(parse_fixed_date)(const ISOFORMAT_CHAR *dtstr, int *year,
+                            int *month, int *day)
+{
+    // YYYY-MM-DD
+    if (dtstr[4] != '-' || dtstr[7] != '-') {
+        return -1;
+    }
+
+    const int y = ISOFORMAT(fixed_digits)(dtstr, 4);
+    const int m = ISOFORMAT(fixed_digits)(dtstr + 5, 2);
+    const int d = ISOFORMAT(fixed_digits)(dtstr + 8, 2);
+    if (y < 0 || m < 0 || d < 0) {
+        return -1;
+    }
+
+    *year = y;
+    *month = m;
+    *day = d;
+    return 0;
+}
+
+static int
+ISOFORMAT(parse_fixed_time)(const ISOFORMAT_CHAR *tstr, size_t len,
+                            int *hour, int *minute, int *second,
+                            int *microsecond, int *tzoffset,
+                            int *tzmicrosecond)
+{
+    // HH:MM[:SS[.fff|.ffffff]][Z|+HH:MM]
+    size_t time_len;
+    switch (len) {
+        case 5:
+        case 8:
+        case 12:
+        case 15:
+            time_len = len;
+            break;
+        case 6:
+        case 9:
+        case 13:
+        case 16:
+            time_len = len - 1;
+            break;
+        case 11:
+        case 14:
+        case 18:
+        case 21:
+            time_len = len - 6;
+            break;
+        default:
+            return -1;
+    }
+
+    if (tstr[2] != ':') {
+        return -1;
+    }
+    const int h = ISOFORMAT(fixed_digits)(tstr, 2);
+    const int m = ISOFORMAT(fixed_digits)(tstr + 3, 2);
+    int s = 0, us = 0;
+
+    if (time_len >= 8) {
+        if (tstr[5] != ':') {
+            return -1;
+        }
+        s = ISOFORMAT(fixed_digits)(tstr + 6, 2);
+    }
+    if (time_len >= 12) {
+        if (tstr[8] != '.') {
+            return -1;
+        }
+        us = ISOFORMAT(fixed_digits)(tstr + 9, time_len - 9);
+        if (time_len == 12 && us >= 0) {
+            us *= 1000;
+        }
+    }
+    if (h < 0 || m < 0 || s < 0 || us < 0) {
+        return -1;
+    }
+
+    const ISOFORMAT_CHAR *tz = tstr + time_len;
+    int rv = 0, offset = 0;
+    if (len == time_len + 1) {
+        if (*tz != 'Z') {
+            return -1;
+        }
+        rv = 1;
+    }
+    else if (len > time_len) {
+        if ((*tz != '+' && *tz != '-') || tz[3] != ':') {
+            return -1;
+        }
+        const int tzh = ISOFORMAT(fixed_digits)(tz + 1, 2);
+        const int tzm = ISOFORMAT(fixed_digits)(tz + 4, 2);
+        if (tzh < 0 || tzm < 0) {
+            return -1;
+        }
+        offset = (*tz == '-' ? -1 : 1) * (tzh * 3600 + tzm * 60);
+        rv = 1;
+    }
+
+    *hour = h;
+    *minute = m;
+    *second = s;
+    *microsecond = us;
+    if (rv) {
+        *tzoffset = offset;
+        *tzmicrosecond = 0;
+    }
+    return rv;
+}
+
+static int
+ISOFORMAT(parse_fixed_datetime)(const ISOFORMAT_CHAR *dtstr, size_t len,
+                                int *year, int *month, int *day, int *hour,
+                                int *minute, int *second, int *microsecond,
+                                int *tzoffset, int *tzusec)
+{
+    // YYYY-MM-DD[*HH:MM[:SS[.fff|.ffffff]][Z|+HH:MM]], where the separator
+    // may be any character
+    if (len != 10 && len <= 11) {
+        return -1;
+    }
+#if ISOFORMAT_UTF8
+    // A multi-byte separator would shift the time
+    if (len > 10 && (dtstr[10] & 0x80)) {
+        return -1;
+    }
+#endif
+
+    int y, mo, d;
+    if (ISOFORMAT(parse_fixed_date)(dtstr, &y, &mo, &d) < 0) {
+        return -1;
+    }
+
+    int rv = 0;
+    if (len > 10) {
+        rv = ISOFORMAT(parse_fixed_time)(dtstr + 11, len - 11, hour, minute,
+                                         second, microsecond, tzoffset,
+                                         tzusec);
+        if (rv < 0) {
+            return -1;
+        }
+    }
+
+    *year = y;
+    *month = mo;
+    *day = d;
+    return rv;
+}
+
+static int
+ISOFORMAT(parse_isoformat_date)(const ISOFORMAT_CHAR *dtstr, const size_t len,
+                                int *year, int *month, int *day)
+{
+    /* Parse the date components of the result of date.isoformat()
+     *
+     *  Return codes:
+     *       0:  Success
+     *      -1:  Failed to parse date component
+     *      -2:  Inconsistent date separator usage
+     *      -3:  Failed to parse ISO week.
+     *      -4:  Failed to parse ISO day.
+     *      -5, -6: Failure in iso_to_ymd
+     */
+    if (len == 10 &&
+        !ISOFORMAT(parse_fixed_date)(dtstr, year, month, day)) {
+        return 0;
+    }
+
+    const ISOFORMAT_CHAR *p = dtstr;
+    const ISOFORMAT_CHAR *p_end = dtstr + len;
+    p = ISOFORMAT(parse_digits)(p, p_end, year, 4);
+    if (NULL == p) {
+        return -1;
+    }
+
+    const unsigned char uses_separator = (p < p_end && *p == '-');
+    if (uses_separator) {
+        ++p;
+    }
+
+    if(p < p_end && *p == 'W') {
+        // This is an isocalendar-style date string
+        p++;
+        int iso_week = 0;
+        int iso_day = 0;
+
+        p = ISOFORMAT(parse_digits)(p, p_end, &iso_week, 2);
+        if (NULL == p) {
+            return -3;
+        }
+
+        assert(p > dtstr);
+        if ((size_t)(p - dtstr) < len) {
+            if (uses_separator && *(p++) != '-') {
+                return -2;
+            }
+
+            p = ISOFORMAT(parse_digits)(p, p_end, &iso_day, 1);
+            if (NULL == p) {
+                return -4;
+            }
+        } else {
+            iso_day = 1;
+        }
+
+        int rv = iso_to_ymd(*year, iso_week, iso_day, year, month, day);
+        if (rv) {
+            return -3 + rv;
+        } else {
+            return 0;
+        }
+    }
+
+    p = ISOFORMAT(parse_digits)(p, p_end, month, 2);
+    if (NULL == p) {
+        return -1;
+    }
+
+    if (uses_separator && (p >= p_end || *(p++) != '-')) {
+        return -2;
+    }
+    p = ISOFORMAT(parse_digits)(p, p_end, day, 2);
+    if (p == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+static int
+ISOFORMAT(parse_hh_mm_ss_ff)(const ISOFORMAT_CHAR *tstr,
+                             const ISOFORMAT_CHAR *tstr_end, int *hour,
+                             int *minute, int *second, int *microsecond,
+                             int *nanosecond)
+{
+    // `nanosecond` is set to the sub-microsecond part of the fraction, which
+    // the datetime types can't represent.
+    *hour = *minute = *second = *microsecond = *nanosecond = 0;
+    const ISOFORMAT_CHAR *p = tstr;
+    const ISOFORMAT_CHAR *p_end = tstr_end;
+    int *vals[3] = {hour, minute, second};
+    size_t i = 0;
+    // This is initialized to satisfy an erroneous compiler warning.
+    unsigned char has_separator = 1;
+
+    // Parse [HH[:?MM[:?SS]]]
+    for (i = 0; i < 3; ++i) {
+        p = ISOFORMAT(parse_digits)(p, p_end, vals[i], 2);
+        if (NULL == p) {
+            return -3;
+        }
+
+        if (p >= p_end) {
+            return 0;
+        }
+
+        ISOFORMAT_CHAR c = *(p++);
+        if (i == 0) {
+            has_separator = (c == ':');
+        }
+
+#if ISOFORMAT_UTF8
+        const int at_end = p >= p_end;
+#else
+        // CPython parses the UTF-8 encoding of the string, where a non-ASCII
+        // character is never the last code unit.
+        const int at_end = p >= p_end && c < 0x80;
+#endif
+        if (at_end) {
+            return c != '\0';
+        }
+        else if (has_separator && (c == ':')) {
+            continue;
+        }
+        else if (c == '.' || c == ',') {
+            break;
+        } else if (!has_separator) {
+            --p;
+        } else {
+            return -4;  // Malformed time separator
+        }
+    }
+
+    // Parse fractional components
+    size_t len_remains = p_end - p;
+    size_t to_parse = len_remains;
+    if (len_remains >= 6) {
+        to_parse = 6;
+    }
+
+    p = ISOFORMAT(parse_digits)(p, p_end, microsecond, to_parse);
+    if (NULL == p) {
+        return -3;
+    }
+
+    static int correction[] = {
+        100000, 10000, 1000, 100, 10
+    };
+
+    if (to_parse < 6) {
+        *microsecond *= correction[to_parse-1];
+    }
+
+    size_t ns_digits = 0;
+    while (p < p_end && is_digit(*p)){
+        if (ns_digits < 3) {
+            *nanosecond = *nanosecond * 10 + (int)(*p - '0');
+            ++ns_digits;
+        }
+        ++p; // skip truncated digits
+    }
+
+    if (ns_digits > 0 && ns_digits < 3) {
+        *nanosecond *= correction[ns_digits + 2];
+    }
+
+    // Return 1 if it's not the end of the string
+    return p < p_end && *p != '\0';
+}
+
+static int
+ISOFORMAT(parse_isoformat_time)(const ISOFORMAT_CHAR *dtstr, size_t dtlen,
+                                int *hour, int *minute, int *second,
+                                int *microsecond, int *nanosecond,
+                                int *tzoffset, int *tzmicrosecond)
+{
+    // Parse the time portion of a datetime.isoformat() string
+    //
+    // Return codes:
+    //      0:  Success (no tzoffset)
+    //      1:  Success (with tzoffset)
+    //     -3:  Failed to parse time component
+    //     -4:  Failed to parse time separator
+    //     -5:  Malformed timezone string
+
+    const ISOFORMAT_CHAR *p = dtstr;
+    const ISOFORMAT_CHAR *p_end = dtstr + dtlen;
+
+    const ISOFORMAT_CHAR *tzinfo_pos = p;
+    while (tzinfo_pos < p_end) {
+        if (*tzinfo_pos == 'Z' || *tzinfo_pos == '+' || *tzinfo_pos == '-') {
+            break;
+        }
+        ++tzinfo_pos;
+    }
+
+    int rv = ISOFORMAT(parse_hh_mm_ss_ff)(dtstr, tzinfo_pos, hour, minute,
+                                          second, microsecond, nanosecond);
+
+    if (rv < 0) {
+        return rv;
+    }
+    else if (tzinfo_pos == p_end) {
+        // We know that there's no time zone, so if there's stuff at the
+        // end of the string it's an error.
+        if (rv == 1) {
+            return -5;
+        }
+        else {
+            return 0;
+        }
+    }
+
+    // Special case UTC / Zulu time.
+    if (*tzinfo_pos == 'Z') {
+        *tzoffset = 0;
+        *tzmicrosecond = 0;
+
+        if (tzinfo_pos + 1 != p_end && *(tzinfo_pos + 1) != '\0') {
+            return -5;
+        } else {
+            return 1;
+        }
+    }
+
+    int tzsign = (*tzinfo_pos == '-') ? -1 : 1;
+    tzinfo_pos++;
+    int tzhour = 0, tzminute = 0, tzsecond = 0, tznanosecond = 0;
+    rv = ISOFORMAT(parse_hh_mm_ss_ff)(tzinfo_pos, p_end, &tzhour, &tzminute,
+                                      &tzsecond, tzmicrosecond,
+                                      &tznanosecond);
+
+    *tzoffset = tzsign * ((tzhour * 3600) + (tzminute * 60) + tzsecond);
+    *tzmicrosecond *= tzsign;
+
+    return rv ? -5 : 1;
+}
+
+static int
+ISOFORMAT(parse_isoformat_time_string)(const ISOFORMAT_CHAR *tstr,
+                                       size_t len, int *hour, int *minute,
+                                       int *second, int *microsecond,
+                                       int *tzoffset, int *tzmicrosecond)
+{
+    // The spec actually requires that time-only ISO 8601 strings start with
+    // T, but the extended format allows this to be omitted as long as there
+    // is no ambiguity with date strings.
+    if (len > 0 && *tstr == 'T') {
+        ++tstr;
+        len -= 1;
+    }
+
+    const int rv = ISOFORMAT(parse_fixed_time)(
+        tstr, len, hour, minute, second, microsecond, tzoffset,
+        tzmicrosecond);
+    if (rv != -1) {
+        return rv;
+    }
+
+    int nanosecond = 0;
+    return ISOFORMAT(parse_isoformat_time)(tstr, len, hour, minute, second,
+                                           microsecond, &nanosecond, tzoffset,
+                                           tzmicrosecond);
+}
+
+static Py_ssize_t
+ISOFORMAT(_find_isoformat_datetime_separator)(const ISOFORMAT_CHAR *dtstr,
+                                              Py_ssize_t len) {
+    // The valid date formats can all be distinguished by characters 4 and 5
+    // and further narrowed down by character
+    // which tells us where to look for the separator character.
+    // Format    |  As-rendered |   Position
+    // ---------------------------------------
+    // %Y-%m-%d  |  YYYY-MM-DD  |    10
+    // %Y%m%d    |  YYYYMMDD    |     8
+    // %Y-W%V    |  YYYY-Www    |     8
+    // %YW%V     |  YYYYWww     |     7
+    // %Y-W%V-%u |  YYYY-Www-d  |    10
+    // %YW%V%u   |  YYYYWwwd    |     8
+    // %Y-%j     |  YYYY-DDD    |     8
+    // %Y%j      |  YYYYDDD     |     7
+    //
+    // Note that because we allow *any* character for the separator, in the
+    // case where character 4 is W, it's not straightforward to determine where
+    // the separator is — in the case of YYYY-Www-d, you have actual ambiguity,
+    // e.g. 2020-W01-0000 could be YYYY-Www-D0HH or YYYY-Www-HHMM, when the
+    // separator character is a number in the former case or a hyphen in the
+    // latter case.
+    //
+    // The case of YYYYWww can be distinguished from YYYYWwwd by tracking ahead
+    // to either the end of the string or the first non-numeric character —
+    // since the time components all come in pairs YYYYWww#HH can be
+    // distinguished from YYYYWwwd#HH by the fact that there will always be an
+    // odd number of digits before the first non-digit character in the former
+    // case.
+    static const char date_separator = '-';
+    static const char week_indicator = 'W';
+
+    if (len == 7) {
+        return 7;
+    }
+
+    if (dtstr[4] == date_separator) {
+        // YYYY-???
+
+        if (dtstr[5] == week_indicator) {
+            // YYYY-W??
+
+            if (len < 8) {
+                return -1;
+            }
+
+            if (len > 8 && dtstr[8] == date_separator) {
+                // YYYY-Www-D (10) or YYYY-Www-HH (8)
+                if (len == 9) { return -1; }
+                if (len > 10 && is_digit(dtstr[10])) {
+                    // This is as far as we'll try to go to resolve the
+                    // ambiguity for the moment — if we have YYYY-Www-##, the
+                    // separator is either a hyphen at 8 or a number at 10.
+                    //
+                    // We'll assume it's a hyphen at 8 because it's way more
+                    // likely that someone will use a hyphen as a separator
+                    // than a number, but at this point it's really best effort
+                    // because this is an extension of the spec anyway.
+                    return 8;
+                }
+
+                return 10;
+            } else {
+                // YYYY-Www (8)
+                return 8;
+            }
+        } else {
+            // YYYY-MM-DD (10)
+            return 10;
+        }
+    } else {
+        // YYYY???
+        if (dtstr[4] == week_indicator) {
+            // YYYYWww (7) or YYYYWwwd (8)
+            size_t idx = 7;
+            for (; idx < (size_t)len; ++idx) {
+                // Keep going until we run out of digits.
+                if (!is_digit(dtstr[idx])) {
+                    break;
+                }
+            }
+
+            if (idx < 9) {
+                return idx;
+            }
+
+            if (idx % 2 == 0) {
+                // If the index of the last number is even, it's YYYYWww
+                return 7;
+            } else {
+                return 8;
+            }
+        } else {
+            // YYYYMMDD (8)
+            return 8;
+        }
+    }
+}
+
+static int
+ISOFORMAT(parse_isoformat_datetime)(const ISOFORMAT_CHAR *dtstr,
+                                    Py_ssize_t len, int *year, int *month,
+                                    int *day, int *hour, int *minute,
+                                    int *second, int *microsecond,
+                                    int *nanosecond, int *tzoffset,
+                                    int *tzusec)
+{
+    // Parse a complete datetime.isoformat() string, whose separator may be
+    // any character.
+    //
+    // Return codes are those of parse_isoformat_date and
+    // parse_isoformat_time.
+    *nanosecond = 0;
+    int rv = ISOFORMAT(parse_fixed_datetime)(
+        dtstr, (size_t)len, year, month, day, hour, minute, second,
+        microsecond, tzoffset, tzusec);
+    if (rv != -1) {
+        return rv;
+    }
+
+    if (len < 7) {  // All valid ISO 8601 strings are at least 7 characters long
+        return -1;
+    }
+
+    const Py_ssize_t separator_location =
+        ISOFORMAT(_find_isoformat_datetime_separator)(dtstr, len);
+
+    if (separator_location < 0) {
+        return -1;
+    }
+
+    const ISOFORMAT_CHAR *p = dtstr;
+    const ISOFORMAT_CHAR *p_end = dtstr + len;
+
+    // date runs up to separator_location
+    rv = ISOFORMAT(parse_isoformat_date)(
+        p, (size_t)(separator_location < len ? separator_location : len),
+        year, month, day);
+
+    if (!rv && len > separator_location) {
+        p += separator_location;
+#if ISOFORMAT_UTF8
+        // In UTF-8, the length of multi-byte characters is encoded in the MSB
+        if ((p[0] & 0x80) == 0) {
+            p += 1;
+        }
+        else {
+            switch (p[0] & 0xf0) {
+                case 0xe0:
+                    p += 3;
+                    break;
+                case 0xf0:
+                    p += 4;
+                    break;
+                default:
+                    p += 2;
+                    break;
+            }
+        }
+
+        if (p > p_end) {
+            // Truncated multi-byte separator
+            return -4;
+        }
+#else
+        p += 1;
+#endif
+
+        rv = ISOFORMAT(parse_isoformat_time)(p, p_end - p, hour, minute,
+                                             second, microsecond, nanosecond,
+                                             tzoffset, tzusec);
+    }
+
+    return rv;
+}
@@ -0,0 +1,210 @@
+/* A fast path for the canonical strings generated by datetime.isoformat():
+ *
+ *   YYYY-MM-DDTHH:MM:SS[.ffffff][Z|+HH:MM]
+ *
+ * (with any ASCII character as the separator), which validates a whole string
+ * with two 16-byte loads and a few vector comparisons, then converts all of
+ * its two-digit fields at once.
+ *
+ * This file is included by _datetimemodule.c, and only defines
+ * HAVE_ISOFORMAT_SSE2 (and the functions below) when SSE2 is available at
+ * compile time. SSE2 is part of the x86-64 baseline, so there is no need for
+ * runtime CPU detection; the longest string handled here is 32 bytes, so
+ * wider vectors wouldn't help either.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_ISOFORMAT_SSE2 1
+
+#include <emmintrin.h>
+#include <stdint.h>
+
+/* Each byte of a string matching a shape must be in [lo, lo + range]. */
+typedef struct {
+    unsigned char lo[16];
+    unsigned char range[16];
+} isoformat_shape;
+
+/* In these patterns, 'D' is a digit, '*' is any ASCII character (the
+ * separator), 's' is the sign of the UTC offset and any other character
+ * matches itself.
+ */
+static const char *const isoformat_patterns[] = {
+    "DDDD-DD-DD*DD:DD:DD",
+    "DDDD-DD-DD*DD:DD:DDZ",
+    "DDDD-DD-DD*DD:DD:DDsDD:DD",
+    "DDDD-DD-DD*DD:DD:DD.DDDDDD",
+    "DDDD-DD-DD*DD:DD:DD.DDDDDDZ",
+    "DDDD-DD-DD*DD:DD:DD.DDDDDDsDD:DD",
+};
+
+#define ISOFORMAT_SHAPES \
+    (sizeof(isoformat_patterns) / sizeof(*isoformat_patterns))
+
+/* The first 16 bytes are the same for all the patterns; the tails are their
+ * last 16 bytes, which overlap the head for the shorter ones.
+ */
+static isoformat_shape isoformat_head;
+static isoformat_shape isoformat_tails[ISOFORMAT_SHAPES];
+
+static void
+set_isoformat_shape(isoformat_shape *shape, const char *pattern)
+{
+    for (size_t i = 0; i < 16; ++i) {
+        switch (pattern[i]) {
+            case 'D':
+                shape->lo[i] = '0';
+                shape->range[i] = 9;
+                break;
+            case '*':
+                shape->lo[i] = 0;
+                shape->range[i] = 0x7f;
+                break;
+            case 's':
+                // This also accepts ',', which is checked separately
+                shape->lo[i] = '+';
+                shape->range[i] = '-' - '+';
+                break;
+            default:
+                shape->lo[i] = (unsigned char)pattern[i];
+                shape->range[i] = 0;
+                break;
+        }
+    }
+}
+
+static void
+initialize_isoformat_sse2(void)
+{
+    set_isoformat_shape(&isoformat_head, isoformat_patterns[0]);
+    for (size_t i = 0; i < ISOFORMAT_SHAPES; ++i) {
+        const char *pattern = isoformat_patterns[i];
+        set_isoformat_shape(&isoformat_tails[i],
+                            pattern + strlen(pattern) - 16);
+    }
+}
+
+static int
+matches_isoformat_shape(__m128i v, const isoformat_shape *shape)
+{
+    const __m128i lo = _mm_loadu_si128((const __m128i *)shape->lo);
+    const __m128i range = _mm_loadu_si128((const __m128i *)shape->range);
+    // (v - lo) <= range, as unsigned bytes
+    const __m128i offset = _mm_sub_epi8(v, lo);
+    const __m128i ok = _mm_cmpeq_epi8(_mm_max_epu8(offset, range), range);
+    return _mm_movemask_epi8(ok) == 0xffff;
+}
+
+/* Store into out[i] the value of the two-digit number starting at byte i of
+ * `v`, for i in [0, 15). Values for bytes that aren't digits are meaningless.
+ */
+static void
+two_digit_numbers(__m128i v, uint16_t out[16])
+{
+    const __m128i digits = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    const __m128i low_bytes = _mm_set1_epi16(0x00ff);
+    const __m128i ten = _mm_set1_epi16(10);
+
+    // Numbers starting at even and at odd positions, one per 16-bit lane
+    const __m128i shifted = _mm_srli_si128(digits, 1);
+    const __m128i even =
+        _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(digits, low_bytes), ten),
+                      _mm_srli_epi16(digits, 8));
+    const __m128i odd =
+        _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(shifted, low_bytes), ten),
+                      _mm_srli_epi16(shifted, 8));
+
+    _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(even, odd));
+    _mm_storeu_si128((__m128i *)(out + 8), _mm_unpackhi_epi16(even, odd));
+}
+
+/* Parse `len` bytes of ASCII-compatible code units (Latin-1 or UTF-8) if they
+ * have one of the canonical shapes above.
+ *
+ * Return codes are those of parse_isoformat_datetime, except -1, which means
+ * that the string must be parsed by parse_isoformat_datetime instead. The
+ * results are always the same as parse_isoformat_datetime's.
+ */
+static int
+parse_isoformat_datetime_sse2(const unsigned char *dtstr, Py_ssize_t len,
+                              int *year, int *month, int *day, int *hour,
+                              int *minute, int *second, int *microsecond,
+                              int *tzoffset, int *tzusec)
+{
+    size_t shape;
+    switch (len) {
+        case 19:
+            shape = 0;
+            break;
+        case 20:
+            shape = 1;
+            break;
+        case 25:
+            shape = 2;
+            break;
+        case 26:
+            shape = 3;
+            break;
+        case 27:
+            shape = 4;
+            break;
+        case 32:
+            shape = 5;
+            break;
+        default:
+            return -1;
+    }
+
+    // The shortest shape is 19 bytes long, so both loads are in bounds.
+    const __m128i head = _mm_loadu_si128((const __m128i *)dtstr);
+    const __m128i tail = _mm_loadu_si128((const __m128i *)(dtstr + len - 16));
+    if (!matches_isoformat_shape(head, &isoformat_head) ||
+        !matches_isoformat_shape(tail, &isoformat_tails[shape])) {
+        return -1;
+    }
+
+    uint16_t h[16], t[16];
+    two_digit_numbers(head, h);
+    two_digit_numbers(tail, t);
+    // The number starting at byte i of the string is t[i - base]
+    const Py_ssize_t base = len - 16;
+
+    *year = h[0] * 100 + h[2];
+    *month = h[5];
+    *day = h[8];
+    *hour = h[11];
+    *minute = h[14];
+    *second = t[17 - base];
+
+    const unsigned char has_fraction = shape >= 3;
+    *microsecond = 0;
+    if (has_fraction) {
+        *microsecond = t[20 - base] * 10000 + t[22 - base] * 100 +
+                       t[24 - base];
+    }
+
+    switch (shape) {
+        case 0:
+        case 3:
+            return 0;
+        case 1:
+        case 4:
+            *tzoffset = 0;
+            *tzusec = 0;
+            return 1;
+        default: {
+            const Py_ssize_t sign_pos = has_fraction ? 26 : 19;
+            if (dtstr[sign_pos] == ',') {
+                return -1;
+            }
+
+            const int tzsign = dtstr[sign_pos] == '-' ? -1 : 1;
+            *tzoffset = tzsign * (t[sign_pos + 1 - base] * 3600 +
+                                  t[sign_pos + 4 - base] * 60);
+            *tzusec = 0;
+            return 1;
+        }
+    }
+}
+
+#endif
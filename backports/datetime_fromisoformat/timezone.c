@@ -39,6 +39,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #define PY_VERSION_AT_LEAST_36 \
     ((PY_MAJOR_VERSION == 3 && PY_MINOR_VERSION >= 6) || PY_MAJOR_VERSION > 3)
+#define PY_VERSION_AT_LEAST_37 \
+    ((PY_MAJOR_VERSION == 3 && PY_MINOR_VERSION >= 7) || PY_MAJOR_VERSION > 3)
 
 /*
  * class FixedOffset(tzinfo):
@@ -48,30 +50,153 @@ typedef struct {
     // Must be in range (-86400, 86400) seconds exclusive.
     // ie. (-1440, 1440) minutes exclusive.
     PyObject_HEAD int offset;
+    // The results of utcoffset() and tzname(), created on first use, since
+    // datetime comparisons and hashes call utcoffset() every time
+    PyObject *utcoffset;
+    PyObject *tzname;
 } FixedOffset;
 
-static int
-FixedOffset_init(FixedOffset *self, PyObject *args, PyObject *kwargs)
+static PyTypeObject FixedOffset_type;
+
+/*
+ * Instantiate new FixedOffset_type object
+ * Skip overhead of calling PyObject_New and PyObject_Init.
+ * Directly allocate object.
+ * Note that this also doesn't do any validation of the offset parameter.
+ * Callers must ensure that offset is within \
+ * the range (-86400, 86400), exclusive.
+ */
+static PyObject *
+new_fixed_offset_ex(int offset, PyTypeObject *type)
 {
-    int offset;
-    if (!PyArg_ParseTuple(args, "i", &offset))
-        return -1;
+    FixedOffset *self = (FixedOffset *)(type->tp_alloc(type, 0));
+
+    if (self != NULL)
+        self->offset = offset;
 
+    return (PyObject *)self;
+}
+
+/*
+ * The offset is set once, in __new__, so that instances are immutable and
+ * can safely be shared (see new_fixed_offset). FixedOffset(offset) returns
+ * the shared instance too, so that unpickling (which calls it for each
+ * tzinfo) doesn't create a new one each time.
+ */
+static PyObject *
+fixed_offset_of_type(PyTypeObject *type, int offset)
+{
     if (abs(offset) >= TWENTY_FOUR_HOURS_IN_SECONDS) {
         PyErr_Format(PyExc_ValueError,
                      "offset must be an integer in the range (-86400, 86400), "
                      "exclusive");
+        return NULL;
+    }
+
+    if (type == &FixedOffset_type)
+        return new_fixed_offset(offset);
+
+    return new_fixed_offset_ex(offset, type);
+}
+
+/*
+ * FixedOffset(offset) takes exactly one positional argument, converted with
+ * the rules of PyArg_ParseTuple's "i" format. Shared by tp_new and the
+ * vectorcall, so that subclasses behave the same.
+ */
+static int
+fixed_offset_args(Py_ssize_t nargs, int has_kwargs)
+{
+    if (has_kwargs) {
+        PyErr_SetString(PyExc_TypeError,
+                        "FixedOffset() takes no keyword arguments");
+        return -1;
+    }
+    if (nargs != 1) {
+        PyErr_Format(PyExc_TypeError,
+                     "FixedOffset() takes exactly one argument (%zd given)",
+                     nargs);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+fixed_offset_arg(PyObject *arg, int *offset)
+{
+    PyObject *index = PyNumber_Index(arg);
+    if (index == NULL)
+        return -1;
+    const long value = PyLong_AsLong(index);
+    Py_DECREF(index);
+    if (value == -1 && PyErr_Occurred())
+        return -1;
+    if (value > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "signed integer is greater than maximum");
+        return -1;
+    }
+    if (value < INT_MIN) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "signed integer is less than minimum");
         return -1;
     }
 
-    self->offset = offset;
+    *offset = (int)value;
     return 0;
 }
 
+static PyObject *
+FixedOffset_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    const int has_kwargs = kwargs != NULL && PyDict_GET_SIZE(kwargs) != 0;
+    int offset;
+    if (fixed_offset_args(PyTuple_GET_SIZE(args), has_kwargs) < 0)
+        return NULL;
+    if (fixed_offset_arg(PyTuple_GET_ITEM(args, 0), &offset) < 0)
+        return NULL;
+
+    return fixed_offset_of_type(type, offset);
+}
+
+#if PY_VERSION_HEX >= 0x03090000
+/* FixedOffset(offset), without building an args tuple. Unlike tp_new, this
+ * isn't inherited, so `type` is always FixedOffset_type.
+ */
+static PyObject *
+FixedOffset_vectorcall(PyObject *type, PyObject *const *args, size_t nargsf,
+                       PyObject *kwnames)
+{
+    const int has_kwargs = kwnames != NULL && PyTuple_GET_SIZE(kwnames) != 0;
+    int offset;
+    if (fixed_offset_args(PyVectorcall_NARGS(nargsf), has_kwargs) < 0)
+        return NULL;
+    if (fixed_offset_arg(args[0], &offset) < 0)
+        return NULL;
+
+    return fixed_offset_of_type((PyTypeObject *)type, offset);
+}
+#endif
+
+static void
+FixedOffset_dealloc(FixedOffset *self)
+{
+    Py_XDECREF(self->utcoffset);
+    Py_XDECREF(self->tzname);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
 static PyObject *
 FixedOffset_utcoffset(FixedOffset *self, PyObject *dt)
 {
-    return PyDelta_FromDSU(0, self->offset, 0);
+    if (self->utcoffset == NULL) {
+        self->utcoffset = PyDelta_FromDSU(0, self->offset, 0);
+        if (self->utcoffset == NULL)
+            return NULL;
+    }
+
+    Py_INCREF(self->utcoffset);
+    return self->utcoffset;
 }
 
 static PyObject *
@@ -95,15 +220,39 @@ FixedOffset_fromutc(FixedOffset *self, PyDateTime_DateTime *dt)
         return NULL;
     }
 
-    return PyNumber_Add((PyObject *)dt,
-                        FixedOffset_utcoffset(self, (PyObject *)self));
+    PyObject *delta = FixedOffset_utcoffset(self, (PyObject *)self);
+    if (delta == NULL)
+        return NULL;
+
+    PyObject *result = PyNumber_Add((PyObject *)dt, delta);
+    Py_DECREF(delta);
+    return result;
 }
 
-static PyObject *
-FixedOffset_tzname(FixedOffset *self, PyObject *dt)
+int
+format_utc_offset(char *buffer, int offset, int with_seconds)
 {
-    int offset = self->offset;
+    char *p = buffer;
+    *p++ = offset < 0 ? '-' : '+';
+    if (offset < 0)
+        offset = -offset;
+
+    const int fields[] = {offset / SECS_PER_HOUR,
+                          offset / SECS_PER_MIN % SECS_PER_MIN,
+                          offset % SECS_PER_MIN};
+    for (int i = 0; i < (with_seconds ? 3 : 2); ++i) {
+        if (i > 0)
+            *p++ = ':';
+        *p++ = '0' + fields[i] / 10 % 10;
+        *p++ = '0' + fields[i] % 10;
+    }
+
+    return (int)(p - buffer);
+}
 
+static PyObject *
+create_tzname(int offset)
+{
     if (offset == 0) {
 #if PY_VERSION_AT_LEAST_36
         return PyUnicode_FromString("UTC");
@@ -114,42 +263,100 @@ FixedOffset_tzname(FixedOffset *self, PyObject *dt)
 #endif
     }
     else {
-        char result_tzname[10] = {0};
-        char sign = '+';
-
-        if (offset < 0) {
-            sign = '-';
-            offset *= -1;
-        }
-        snprintf(result_tzname, 10, "UTC%c%02u:%02u", sign,
-                 (offset / SECS_PER_HOUR) & 31,
-                 offset / SECS_PER_MIN % SECS_PER_MIN);
+        char result_tzname[10] = {'U', 'T', 'C'};
+        const int len = 3 + format_utc_offset(result_tzname + 3, offset, 0);
 #if PY_MAJOR_VERSION >= 3
-        return PyUnicode_FromString(result_tzname);
+        return PyUnicode_FromStringAndSize(result_tzname, len);
 #else
-        return PyString_FromString(result_tzname);
+        return PyString_FromStringAndSize(result_tzname, len);
 #endif
     }
 }
 
+static PyObject *
+FixedOffset_tzname(FixedOffset *self, PyObject *dt)
+{
+    if (self->tzname == NULL) {
+        self->tzname = create_tzname(self->offset);
+        if (self->tzname == NULL)
+            return NULL;
+    }
+
+    Py_INCREF(self->tzname);
+    return self->tzname;
+}
+
+int
+get_fixed_offset(PyObject *tzinfo, int *offset)
+{
+    if (Py_TYPE(tzinfo) != &FixedOffset_type)
+        return 0;
+
+    *offset = ((FixedOffset *)tzinfo)->offset;
+    return 1;
+}
+
 static PyObject *
 FixedOffset_repr(FixedOffset *self)
 {
     return FixedOffset_tzname(self, NULL);
 }
 
+/*
+ * Instances with the same offset are equal (so that their hashes are too),
+ * without creating their utcoffset().
+ */
+static Py_hash_t
+FixedOffset_hash(FixedOffset *self)
+{
+    return self->offset == -1 ? -2 : self->offset;
+}
+
+static PyObject *
+FixedOffset_richcompare(PyObject *self, PyObject *other, int op)
+{
+    if ((op != Py_EQ && op != Py_NE) ||
+        !PyObject_TypeCheck(other, &FixedOffset_type)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+
+    const int equal =
+        ((FixedOffset *)self)->offset == ((FixedOffset *)other)->offset;
+    if (equal == (op == Py_EQ))
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
 static PyObject *
 FixedOffset_getinitargs(FixedOffset *self)
 {
-    PyObject *args = PyTuple_Pack(1, PyLong_FromLong(self->offset));
-    return args;
+    return Py_BuildValue("(i)", self->offset);
+}
+
+/*
+ * Pickled as FixedOffset(offset), which shares the unpickled instances.
+ * tzinfo's __reduce__ would look up __getinitargs__ and __getstate__ on
+ * every instance instead, and is still used by subclasses, which may have
+ * a __dict__ to pickle.
+ */
+static PyObject *
+FixedOffset_reduce(FixedOffset *self, PyObject *unused)
+{
+    if (Py_TYPE(self) != &FixedOffset_type) {
+        return PyObject_CallMethod((PyObject *)PyDateTimeAPI->TZInfoType,
+                                   "__reduce__", "O", (PyObject *)self);
+    }
+
+    return Py_BuildValue("O(i)", (PyObject *)&FixedOffset_type,
+                         self->offset);
 }
 
 /*
  * Class member / class attributes
  */
 static PyMemberDef FixedOffset_members[] = {
-    {"offset", T_INT, offsetof(FixedOffset, offset), 0, "UTC offset"}, {NULL}};
+    {"offset", T_INT, offsetof(FixedOffset, offset), READONLY, "UTC offset"},
+    {NULL}};
 
 /*
  * Class methods
@@ -169,13 +376,16 @@ static PyMethodDef FixedOffset_methods[] = {
     {"__getinitargs__", (PyCFunction)FixedOffset_getinitargs, METH_NOARGS,
      PyDoc_STR("pickle support")},
 
+    {"__reduce__", (PyCFunction)FixedOffset_reduce, METH_NOARGS,
+     PyDoc_STR("pickle support")},
+
     {NULL}};
 
 static PyTypeObject FixedOffset_type = {
     PyVarObject_HEAD_INIT(NULL, 0) "backports.datetime_fromisoformat.FixedOffset", /* tp_name */
     sizeof(FixedOffset),                      /* tp_basicsize */
     0,                                        /* tp_itemsize */
-    0,                                        /* tp_dealloc */
+    (destructor)FixedOffset_dealloc,          /* tp_dealloc */
     0,                                        /* tp_print */
     0,                                        /* tp_getattr */
     0,                                        /* tp_setattr */
@@ -184,7 +394,7 @@ static PyTypeObject FixedOffset_type = {
     0,                                        /* tp_as_number */
     0,                                        /* tp_as_sequence */
     0,                                        /* tp_as_mapping */
-    0,                                        /* tp_hash  */
+    (hashfunc)FixedOffset_hash,               /* tp_hash  */
     0,                                        /* tp_call */
     (reprfunc)FixedOffset_repr,               /* tp_str */
     0,                                        /* tp_getattro */
@@ -195,28 +405,152 @@ static PyTypeObject FixedOffset_type = {
 };
 
 /*
- * Instantiate new FixedOffset_type object
- * Skip overhead of calling PyObject_New and PyObject_Init.
- * Directly allocate object.
- * Note that this also doesn't do any validation of the offset parameter.
- * Callers must ensure that offset is within \
- * the range (-86400, 86400), exclusive.
+ * Parsing a list of aware strings would otherwise allocate one tzinfo per
+ * string, even though nearly all of them share a handful of offsets.
+ * Instead, tzinfo objects are handed out from caches of shared instances,
+ * which live for as long as the module does:
+ *   - every whole-minute offset in (-24h, 24h) has a slot in
+ *     whole_minutes, indexed by the offset in minutes + 1439.
+ *   - offsets with a seconds component share a small direct-mapped cache,
+ *     where a newer offset evicts the one occupying its slot.
  */
-PyObject *
-new_fixed_offset_ex(int offset, PyTypeObject *type)
+#define MINUTES_PER_DAY (TWENTY_FOUR_HOURS_IN_SECONDS / SECS_PER_MIN)
+#define SUB_MINUTE_OFFSET_CACHE_SIZE 64
+
+typedef struct {
+    PyObject *whole_minutes[2 * MINUTES_PER_DAY - 1];
+    PyObject *sub_minutes[SUB_MINUTE_OFFSET_CACHE_SIZE];
+    int sub_minute_offsets[SUB_MINUTE_OFFSET_CACHE_SIZE];
+} tzinfo_cache;
+
+static tzinfo_cache fixed_offset_cache;
+static tzinfo_cache timezone_cache;
+
+static PyObject *
+cached_tzinfo(tzinfo_cache *cache, int offset,
+              PyObject *(*factory)(int offset))
 {
-    FixedOffset *self = (FixedOffset *)(type->tp_alloc(type, 0));
+    PyObject **slot;
 
-    if (self != NULL)
-        self->offset = offset;
+    if (offset % SECS_PER_MIN == 0) {
+        slot = &cache->whole_minutes[offset / SECS_PER_MIN +
+                                     MINUTES_PER_DAY - 1];
+    }
+    else {
+        size_t idx = (unsigned int)offset % SUB_MINUTE_OFFSET_CACHE_SIZE;
+        slot = &cache->sub_minutes[idx];
+        if (*slot != NULL && cache->sub_minute_offsets[idx] != offset) {
+            Py_CLEAR(*slot);
+        }
+        cache->sub_minute_offsets[idx] = offset;
+    }
 
-    return (PyObject *)self;
+    if (*slot == NULL) {
+        *slot = factory(offset);
+        if (*slot == NULL)
+            return NULL;
+    }
+
+    Py_INCREF(*slot);
+    return *slot;
+}
+
+static PyObject *
+create_fixed_offset(int offset)
+{
+    return new_fixed_offset_ex(offset, &FixedOffset_type);
 }
 
 PyObject *
 new_fixed_offset(int offset)
 {
-    return new_fixed_offset_ex(offset, &FixedOffset_type);
+    return cached_tzinfo(&fixed_offset_cache, offset, create_fixed_offset);
+}
+
+/*
+ * The stdlib's `datetime.timezone` is implemented in C, so datetime
+ * arithmetic and comparisons involving its instances take CPython's fast
+ * paths (eg. `timezone.utc` is special cased). set_timezone_mode lets users
+ * choose to get those instead of FixedOffset.
+ */
+static PyObject *timezone_type = NULL;
+static PyObject *timezone_utc = NULL;
+
+static int timezone_mode = TIMEZONE_MODE_FIXED_OFFSET;
+
+static const char *const timezone_mode_names[] = {
+    "fixed_offset",  // TIMEZONE_MODE_FIXED_OFFSET
+    "utc",           // TIMEZONE_MODE_UTC
+    "timezone",      // TIMEZONE_MODE_TIMEZONE
+};
+
+static PyObject *
+create_timezone(int offset)
+{
+    PyObject *delta = PyDelta_FromDSU(0, offset, 0);
+    if (delta == NULL)
+        return NULL;
+
+    PyObject *tz = PyObject_CallFunctionObjArgs(timezone_type, delta, NULL);
+    Py_DECREF(delta);
+    return tz;
+}
+
+PyObject *
+new_tzinfo(int offset)
+{
+    switch (timezone_mode) {
+        case TIMEZONE_MODE_TIMEZONE:
+#if !PY_VERSION_AT_LEAST_37
+            // `timezone` only supports whole minute offsets before 3.7
+            if (offset % SECS_PER_MIN != 0)
+                return new_fixed_offset(offset);
+#endif
+            if (offset != 0)
+                return cached_tzinfo(&timezone_cache, offset,
+                                     create_timezone);
+            /* fall through */
+        case TIMEZONE_MODE_UTC:
+            if (offset == 0) {
+                Py_INCREF(timezone_utc);
+                return timezone_utc;
+            }
+            /* fall through */
+        default:
+            return new_fixed_offset(offset);
+    }
+}
+
+PyObject *
+get_timezone_mode(void)
+{
+    return PyUnicode_FromString(timezone_mode_names[timezone_mode]);
+}
+
+PyObject *
+set_timezone_mode(PyObject *mode)
+{
+    if (!PyUnicode_Check(mode)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "set_timezone_mode: mode must be str");
+        return NULL;
+    }
+
+    for (int i = 0; i < (int)(sizeof(timezone_mode_names) /
+                              sizeof(*timezone_mode_names));
+         ++i) {
+        if (PyUnicode_CompareWithASCIIString(mode, timezone_mode_names[i]) ==
+            0) {
+            timezone_mode = i;
+            Py_RETURN_NONE;
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError,
+                 "set_timezone_mode: mode must be one of 'fixed_offset', "
+                 "'utc' or 'timezone', not %R",
+                 mode);
+    return NULL;
 }
 
 /* ------------------------------------------------------------- */
@@ -225,15 +559,31 @@ int
 initialize_timezone_code(PyObject *module)
 {
     PyDateTime_IMPORT;
-    FixedOffset_type.tp_new = PyType_GenericNew;
+    FixedOffset_type.tp_new = FixedOffset_new;
     FixedOffset_type.tp_base = PyDateTimeAPI->TZInfoType;
     FixedOffset_type.tp_methods = FixedOffset_methods;
     FixedOffset_type.tp_members = FixedOffset_members;
-    FixedOffset_type.tp_init = (initproc)FixedOffset_init;
+    FixedOffset_type.tp_richcompare = FixedOffset_richcompare;
+#if PY_VERSION_HEX >= 0x03090000
+    FixedOffset_type.tp_vectorcall = FixedOffset_vectorcall;
+#endif
 
     if (PyType_Ready(&FixedOffset_type) < 0)
         return -1;
 
+    PyObject *datetime_module = PyImport_ImportModule("datetime");
+    if (datetime_module == NULL)
+        return -1;
+
+    timezone_type = PyObject_GetAttrString(datetime_module, "timezone");
+    Py_DECREF(datetime_module);
+    if (timezone_type == NULL)
+        return -1;
+
+    timezone_utc = PyObject_GetAttrString(timezone_type, "utc");
+    if (timezone_utc == NULL)
+        return -1;
+
     Py_INCREF(&FixedOffset_type);
     if (PyModule_AddObject(module, "FixedOffset",
                            (PyObject *)&FixedOffset_type) < 0) {
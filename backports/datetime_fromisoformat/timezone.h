@@ -3,9 +3,39 @@
 
 #include <Python.h>
 
+enum {
+    TIMEZONE_MODE_FIXED_OFFSET = 0,
+    TIMEZONE_MODE_UTC,
+    TIMEZONE_MODE_TIMEZONE,
+};
+
 PyObject *
 new_fixed_offset(int offset);
 
+/* Returns the tzinfo for `offset` according to the current timezone mode */
+PyObject *
+new_tzinfo(int offset);
+
+/* If `tzinfo` is exactly a FixedOffset (whose subclasses may override
+ * utcoffset), store its offset in seconds into `*offset` and return 1, else
+ * return 0.
+ */
+int
+get_fixed_offset(PyObject *tzinfo, int *offset);
+
+/* Write `offset` seconds (in (-86400, 86400)) as [+-]HH:MM, followed by :SS
+ * if `with_seconds`, without a NUL. Return the number of chars written, at
+ * most 9.
+ */
+int
+format_utc_offset(char *buffer, int offset, int with_seconds);
+
+PyObject *
+get_timezone_mode(void);
+
+PyObject *
+set_timezone_mode(PyObject *mode);
+
 int
 initialize_timezone_code(PyObject *module);
 
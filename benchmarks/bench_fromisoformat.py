@@ -0,0 +1,183 @@
+"""Benchmarks of the parsers, per branch of the grammar, against the interpreter's native fromisoformat methods
+(and ciso8601, if it is installed) where they accept the same strings.
+
+    python benchmarks/bench_fromisoformat.py -o results.json
+    python -m pyperf compare_to baseline.json results.json
+
+Each benchmark parses the strings of one branch of the corpus, and its timings are per string, except for the
+import_time ones, which time the start of an interpreter. With --allocations, the number of memory blocks (and bytes)
+still allocated for each parsed string is printed instead, without running pyperf.
+"""
+import argparse
+import gc
+import os
+import sys
+import time
+import tracemalloc
+
+from datetime import date, datetime, time as time_type
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from corpus import generate_corpus  # noqa: E402
+
+from backports.datetime_fromisoformat import (  # noqa: E402
+    date_fromisoformat, datetime_fromisoformat, datetime_fromisoformat_many, datetime_fromisoformat_to_epoch,
+    is_isoformat_datetime, isoformat_many, parse_isoformat_fields, time_fromisoformat)
+
+try:
+    import ciso8601
+except ImportError:
+    ciso8601 = None
+
+
+def _coerce(func):
+    return lambda s: func(s, errors='coerce')
+
+
+def _parsers(kind, branch):
+    """Return a list of (implementation, function) parsing the strings of a branch."""
+    backport = {'date': date_fromisoformat, 'time': time_fromisoformat, 'datetime': datetime_fromisoformat}[kind]
+    if branch.endswith('_invalid'):
+        # Without raising, since the cost of exceptions would swamp the parsing
+        return [('backport', _coerce(backport))]
+
+    parsers = [('backport', backport)]
+    # Before 3.11, the native methods only accept the output of isoformat(), and don't exist before 3.7. Importing
+    # the backport doesn't patch them.
+    native = getattr({'date': date, 'time': time_type, 'datetime': datetime}[kind], 'fromisoformat', None)
+    if native is not None:
+        parsers.append(('native', native))
+    if ciso8601 is not None and kind == 'datetime':
+        parsers.append(('ciso8601', ciso8601.parse_datetime))
+    return parsers
+
+
+def _accepts_all(func, strings):
+    try:
+        for s in strings:
+            func(s)
+    except (TypeError, ValueError):
+        return False
+    return True
+
+
+def _time_calls(loops, func, strings):
+    range_it = range(loops)
+    t0 = time.perf_counter()
+    for _ in range_it:
+        for s in strings:
+            func(s)
+    return time.perf_counter() - t0
+
+
+def _time_keyword_calls(loops, func, strings):
+    # The keyword is passed here rather than by a wrapper, to time the call itself
+    range_it = range(loops)
+    t0 = time.perf_counter()
+    for _ in range_it:
+        for s in strings:
+            func(s, errors='coerce')
+    return time.perf_counter() - t0
+
+
+def _time_many(loops, strings):
+    range_it = range(loops)
+    t0 = time.perf_counter()
+    for _ in range_it:
+        datetime_fromisoformat_many(strings)
+    return time.perf_counter() - t0
+
+
+def _time_isoformat(loops, datetimes):
+    range_it = range(loops)
+    t0 = time.perf_counter()
+    for _ in range_it:
+        ''.join([dt.isoformat() + '\n' for dt in datetimes])
+    return time.perf_counter() - t0
+
+
+def _time_isoformat_many(loops, datetimes):
+    range_it = range(loops)
+    t0 = time.perf_counter()
+    for _ in range_it:
+        isoformat_many(datetimes)
+    return time.perf_counter() - t0
+
+
+def _benchmarks(corpus):
+    """Yield (name, function, strings) for every benchmark of the corpus."""
+    for branch, (kind, strings) in sorted(corpus.items()):
+        for implementation, func in _parsers(kind, branch):
+            if _accepts_all(func, strings):
+                yield '%s/%s' % (branch, implementation), func, strings
+
+
+def print_allocations(corpus):
+    for name, func, strings in _benchmarks(corpus):
+        gc.collect()
+        blocks = sys.getallocatedblocks()
+        results = [func(s) for s in strings]
+        blocks = sys.getallocatedblocks() - blocks
+        del results
+
+        # Separately, since tracemalloc allocates blocks of its own
+        tracemalloc.start()
+        results = [func(s) for s in strings]
+        size = tracemalloc.get_traced_memory()[0]
+        tracemalloc.stop()
+        del results
+        print('%-45s %5.2f blocks %7.1f bytes per string' % (name, blocks / len(strings), size / len(strings)))
+
+
+def _add_cmdline_args(cmd, args):
+    # Passed on to the worker processes spawned by pyperf
+    cmd.extend(('--corpus-size', str(args.corpus_size)))
+
+
+def main():
+    if '--allocations' in sys.argv[1:]:
+        parser = argparse.ArgumentParser()
+        parser.add_argument('--allocations', action='store_true')
+        parser.add_argument('--corpus-size', type=int, default=1000)
+        print_allocations(generate_corpus(parser.parse_args().corpus_size))
+        return
+
+    import pyperf
+
+    runner = pyperf.Runner(add_cmdline_args=_add_cmdline_args)
+    runner.argparser.add_argument('--corpus-size', type=int, default=1000)
+    runner.argparser.add_argument('--allocations', action='store_true',
+                                  help='print the memory allocated per parsed string instead')
+    runner.metadata['description'] = 'backports.datetime_fromisoformat parsers, per branch of the grammar'
+    corpus = generate_corpus(runner.parse_args().corpus_size)
+
+    for name, func, strings in _benchmarks(corpus):
+        runner.bench_time_func(name, _time_calls, func, strings, inner_loops=len(strings))
+
+    # Compared to datetime_isoformat/backport, the cost of keyword options and of the other entry points
+    strings = corpus['datetime_isoformat'][1]
+    runner.bench_time_func('datetime_isoformat/backport_errors', _time_keyword_calls, datetime_fromisoformat, strings,
+                           inner_loops=len(strings))
+    runner.bench_time_func('datetime_isoformat/backport_to_epoch', _time_calls, datetime_fromisoformat_to_epoch,
+                           strings, inner_loops=len(strings))
+    runner.bench_time_func('datetime_isoformat/backport_many', _time_many, strings, inner_loops=len(strings))
+    runner.bench_time_func('datetime_isoformat/backport_is_isoformat', _time_calls, is_isoformat_datetime, strings,
+                           inner_loops=len(strings))
+    runner.bench_time_func('datetime_isoformat/backport_fields', _time_calls, parse_isoformat_fields, strings,
+                           inner_loops=len(strings))
+
+    # Formatting the parsed datetimes back into newline-separated strings
+    datetimes = datetime_fromisoformat_many(strings)
+    runner.bench_time_func('isoformat/native', _time_isoformat, datetimes, inner_loops=len(datetimes))
+    runner.bench_time_func('isoformat/backport_many', _time_isoformat_many, datetimes, inner_loops=len(datetimes))
+
+    # The start-up cost of a process using the backport, compared to one only importing datetime
+    runner.bench_command('import_time/datetime', [sys.executable, '-c', 'import datetime'])
+    runner.bench_command('import_time/backport', [
+        sys.executable, '-c',
+        'from backports.datetime_fromisoformat import MonkeyPatch; MonkeyPatch.patch_fromisoformat()'])
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,160 @@
+"""A generated corpus of ISO 8601 strings, with one list of strings per branch of the parsers.
+
+The strings are generated from a fixed seed, so every run (and every machine) parses the same corpus, without
+downloading anything.
+"""
+import random
+
+from datetime import datetime, timedelta
+
+SEED = 20140205
+SIZE = 1000
+
+_START = datetime(1970, 1, 1)
+_SPAN = timedelta(days=365 * 100)
+
+
+def _random_datetime(r):
+    return _START + timedelta(microseconds=r.randrange(int(_SPAN.total_seconds() * 1000000)))
+
+
+def _random_offset(r):
+    return r.choice('+-'), r.randrange(24), r.randrange(60)
+
+
+def _week_date(dt):
+    year, week, day = dt.isocalendar()[:3]
+    return year, week, day
+
+
+def _date_extended(r):
+    return _random_datetime(r).strftime('%Y-%m-%d')
+
+
+def _date_basic(r):
+    return _random_datetime(r).strftime('%Y%m%d')
+
+
+def _date_week(r):
+    return '%04d-W%02d' % _week_date(_random_datetime(r))[:2]
+
+
+def _date_week_basic(r):
+    return '%04dW%02d' % _week_date(_random_datetime(r))[:2]
+
+
+def _date_week_day(r):
+    return '%04d-W%02d-%d' % _week_date(_random_datetime(r))
+
+
+def _date_week_day_basic(r):
+    return '%04dW%02d%d' % _week_date(_random_datetime(r))
+
+
+def _time(timespec):
+    return lambda r: _random_datetime(r).time().isoformat(timespec)
+
+
+def _time_basic(r):
+    return _random_datetime(r).strftime('%H%M%S')
+
+
+def _time_offset(r):
+    return _random_datetime(r).strftime('%H:%M:%S') + '%s%02d:%02d' % _random_offset(r)
+
+
+def _isoformat(timespec='auto', sep='T', suffix=''):
+    return lambda r: _random_datetime(r).isoformat(sep, timespec) + suffix
+
+
+def _isoformat_offset(timespec, offset_format):
+    def generate(r):
+        sign, hours, minutes = _random_offset(r)
+        offset = offset_format.format(sign=sign, hours=hours, minutes=minutes, seconds=r.randrange(60))
+        return _random_datetime(r).isoformat('T', timespec) + offset
+
+    return generate
+
+
+def _datetime_basic(r):
+    return _random_datetime(r).strftime('%Y%m%dT%H%M%S')
+
+
+def _datetime_week(r):
+    dt = _random_datetime(r)
+    return '%04d-W%02d-%dT' % _week_date(dt) + dt.strftime('%H:%M:%S')
+
+
+def _datetime_week_basic(r):
+    dt = _random_datetime(r)
+    return '%04dW%02d%dT' % _week_date(dt) + dt.strftime('%H%M%SZ')
+
+
+def _datetime_comma(r):
+    return _random_datetime(r).isoformat('T', 'milliseconds').replace('.', ',')
+
+
+def _datetime_nanoseconds(r):
+    return _random_datetime(r).isoformat('T', 'microseconds') + '%03d' % r.randrange(1000)
+
+
+def _datetime_invalid(r):
+    dt = _random_datetime(r)
+    return r.choice([
+        dt.strftime('%Y-02-30T%H:%M:%S'),
+        dt.strftime('%Y-%m-%dT24:%M:%S'),
+        dt.strftime('%Y-%m-%dT%H:%M:%S+24:00'),
+        dt.strftime('%Y-%m-%dT%H:%M:%SX'),
+        dt.strftime('%Y/%m/%d %H:%M:%S'),
+    ])
+
+
+def _encoded(generate):
+    return lambda r: generate(r).encode('utf-8')
+
+
+# (name, type, generator): `type` is the function that parses the strings ('date', 'time' or 'datetime')
+BRANCHES = [
+    ('date_extended', 'date', _date_extended),
+    ('date_basic', 'date', _date_basic),
+    ('date_week', 'date', _date_week),
+    ('date_week_basic', 'date', _date_week_basic),
+    ('date_week_day', 'date', _date_week_day),
+    ('date_week_day_basic', 'date', _date_week_day_basic),
+    ('time_hours', 'time', _time('hours')),
+    ('time_minutes', 'time', _time('minutes')),
+    ('time_seconds', 'time', _time('seconds')),
+    ('time_milliseconds', 'time', _time('milliseconds')),
+    ('time_microseconds', 'time', _time('microseconds')),
+    ('time_basic', 'time', _time_basic),
+    ('time_offset', 'time', _time_offset),
+    ('datetime_isoformat', 'datetime', _isoformat_offset('microseconds', '{sign}{hours:02d}:{minutes:02d}')),
+    ('datetime_isoformat_naive', 'datetime', _isoformat('seconds')),
+    ('datetime_isoformat_z', 'datetime', _isoformat('microseconds', suffix='Z')),
+    ('datetime_isoformat_space', 'datetime', _isoformat('seconds', sep=' ')),
+    ('datetime_minutes', 'datetime', _isoformat('minutes')),
+    ('datetime_milliseconds', 'datetime', _isoformat('milliseconds')),
+    ('datetime_basic', 'datetime', _datetime_basic),
+    ('datetime_week', 'datetime', _datetime_week),
+    ('datetime_week_basic', 'datetime', _datetime_week_basic),
+    ('datetime_comma', 'datetime', _datetime_comma),
+    ('datetime_nanoseconds', 'datetime', _datetime_nanoseconds),
+    ('datetime_offset_hours', 'datetime', _isoformat_offset('seconds', '{sign}{hours:02d}')),
+    ('datetime_offset_basic', 'datetime', _isoformat_offset('seconds', '{sign}{hours:02d}{minutes:02d}')),
+    ('datetime_offset_seconds', 'datetime',
+     _isoformat_offset('seconds', '{sign}{hours:02d}:{minutes:02d}:{seconds:02d}')),
+    ('datetime_separator_latin1', 'datetime', _isoformat('seconds', sep='é')),
+    ('datetime_separator_ucs2', 'datetime', _isoformat('seconds', sep='時')),
+    ('datetime_separator_surrogate', 'datetime', _isoformat('seconds', sep='\ud800')),
+    ('datetime_bytes', 'datetime', _encoded(_isoformat_offset('microseconds', '{sign}{hours:02d}:{minutes:02d}'))),
+    ('datetime_invalid', 'datetime', _datetime_invalid),
+]
+
+
+def generate_corpus(size=SIZE, seed=SEED):
+    """Return a dict of {branch name: (type, list of strings)}."""
+    corpus = {}
+    for name, kind, generate in BRANCHES:
+        r = random.Random('%s-%s' % (seed, name))
+        corpus[name] = (kind, [generate(r) for _ in range(size)])
+    return corpus
@@ -26,11 +26,16 @@ if os.environ.get("STRICT_WARNINGS", "0") == "1":
     os.environ["_CL_"] += " /WX"
 
 setup(
-    packages=["backports", "backports.datetime_fromisoformat"],
+    # `backports` is a native (PEP 420) namespace package, shared with the other backports
+    packages=["backports.datetime_fromisoformat"],
+    # The C API, for other extension modules
+    package_data={"backports.datetime_fromisoformat": ["datetime_fromisoformat_api.h", "datetime_fromisoformat_api.pxd"]},
 
     ext_modules=[Extension("backports._datetime_fromisoformat", [
         os.path.join("backports", "datetime_fromisoformat", "module.c"),
         os.path.join("backports", "datetime_fromisoformat", "_datetimemodule.c"),
-        os.path.join("backports", "datetime_fromisoformat", "timezone.c")
+        os.path.join("backports", "datetime_fromisoformat", "timezone.c"),
+        os.path.join("backports", "datetime_fromisoformat", "isoformat.c"),
+        os.path.join("backports", "datetime_fromisoformat", "parallel.c")
     ])],
 )
@@ -1,15 +1,31 @@
+import array
 import copy
+import ctypes
+import gc
 import io
 import itertools
+import os
 import pickle
 import pytz
 import re
+import subprocess
 import sys
+import tempfile
+import timeit
 import unittest
-
-from datetime import date, datetime, time, timedelta
-
-from backports.datetime_fromisoformat import MonkeyPatch
+import weakref
+
+from datetime import date, datetime, time, timedelta, timezone
+
+import backports._datetime_fromisoformat
+from backports.datetime_fromisoformat import FixedOffset, IncrementalParser, IsoformatFields, MonkeyPatch, get_include
+from backports.datetime_fromisoformat import (
+    date_fromisoformat, date_fromisoformat_many, date_fromisoformat_to_days, datetime_fromisoformat,
+    datetime_fromisoformat_lines, datetime_fromisoformat_many, datetime_fromisoformat_to_epoch,
+    datetime_fromisoformat_to_epoch_arrow, get_result_cache_info, get_timezone_mode, is_isoformat_date,
+    is_isoformat_date_many, is_isoformat_datetime, is_isoformat_datetime_many, is_isoformat_time,
+    is_isoformat_time_many, isoformat_many, parse_isoformat_fields, parse_isoformat_prefix, set_result_cache,
+    set_timezone_mode, time_fromisoformat, time_fromisoformat_many)
 MonkeyPatch.patch_fromisoformat()
 
 
@@ -18,6 +34,37 @@ class TestFromIsoFormat(unittest.TestCase):
         expected = datetime(2014, 2, 5, 23, 45)
         self.assertEqual(expected, datetime.fromisoformat(expected.isoformat()))
 
+    def test_subclasses(self):
+        class Date(date):
+            pass
+
+        class Time(time):
+            pass
+
+        class DateTime(datetime):
+            pass
+
+        tz = timezone(timedelta(hours=1))
+        for cls, s, expected in [(Date, '2014-W06-3', date(2014, 2, 5)),
+                                 (Time, '23:45+01:00', time(23, 45, tzinfo=tz)),
+                                 (DateTime, '2014-02-05T23:45:12.5+01:00', datetime(2014, 2, 5, 23, 45, 12, 500000, tz))]:
+            with self.subTest(cls=cls):
+                result = cls.fromisoformat(s)
+                self.assertIs(type(result), cls)
+                self.assertEqual(result, expected)
+                # Also through instances, like any classmethod
+                self.assertIs(type(result.fromisoformat(s)), cls)
+
+    def test_patch_imports(self):
+        # Patching is done in C, without ctypes
+        code = ('import sys; modules = set(sys.modules); '
+                'from backports.datetime_fromisoformat import MonkeyPatch; MonkeyPatch.patch_fromisoformat(); '
+                'print(sorted(set(sys.modules) - modules))')
+        env = dict(os.environ, PYTHONPATH=os.pathsep.join(sys.path))
+        imported = subprocess.check_output([sys.executable, '-c', code], env=env, universal_newlines=True)
+        for module in ['ctypes', 'os', 'pkgutil']:
+            self.assertNotIn("'%s'" % module, imported)
+
 
 class TestsFromCPython(unittest.TestCase):
     # These test cases are taken from cPython's `Lib/test/datetimetester.py`
@@ -626,5 +673,1090 @@ class TestCopy(unittest.TestCase):
         dt3 = copy.deepcopy(dt)
         self.assertEqual(dt, dt3)
 
+class TestFromIsoFormatMany(unittest.TestCase):
+    def test_many(self):
+        cases = [
+            (date_fromisoformat_many, date,
+             ['2014-02-05', '20140205', '2025-W01-4']),
+            (time_fromisoformat_many, time,
+             ['23:45', '23:45:12.123456', '12:00:00+05:30']),
+            (datetime_fromisoformat_many, datetime,
+             ['2014-02-05T23:45', '2014-02-05 23:45:12.123Z', '2025W014T1200-0130']),
+        ]
+
+        for parse_many, cls, strs in cases:
+            expected = [cls.fromisoformat(s) for s in strs]
+            for container in [list, tuple, iter]:
+                with self.subTest(parse_many=parse_many.__name__, container=container):
+                    self.assertEqual(parse_many(container(strs)), expected)
+
+            self.assertEqual(parse_many([]), [])
+
+    def test_many_fails(self):
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_many(['2014-02-05T23:45', '2014-02-05X'])
+
+        with self.assertRaises(TypeError):
+            date_fromisoformat_many(['2014-02-05', None])
+
+        with self.assertRaises(TypeError):
+            time_fromisoformat_many(None)
+
+    def test_many_threads(self):
+        # Enough strings to be split between threads, of every kind
+        cases = [
+            (date_fromisoformat_many,
+             ['2014-02-05', b'20140205', bytearray(b'2025-W01-4')]),
+            (time_fromisoformat_many,
+             ['23:45', b'23:45:12.123456', '12:00:00+05:30']),
+            (datetime_fromisoformat_many,
+             ['2014-02-05T23:45', b'2014-02-05 23:45:12.123Z', memoryview(b'2025W014T1200-0130'),
+              '2014-02-05\u00e923:45', '2018-01-31\u664223:59:47.124789', '2014-02-05\U0001f60023:45',
+              '2014-02-05\ud80023:45']),
+        ]
+
+        for parse_many, strs in cases:
+            strs = strs * 5000
+            expected = parse_many(strs)
+            for threads in [2, 4]:
+                with self.subTest(parse_many=parse_many.__name__, threads=threads):
+                    self.assertEqual(parse_many(strs, threads=threads), expected)
+                    self.assertEqual(parse_many(iter(strs), threads=threads), expected)
+
+            self.assertEqual(parse_many([], threads=4), [])
+
+    def test_many_threads_fails(self):
+        strs = ['2014-02-05T23:45'] * 10000
+        for bad, error in [('2014-02-05X', ValueError), ('2014-02-05T23:45\ud800', ValueError),
+                           (None, TypeError)]:
+            for pos in [0, 5000, 9999]:
+                with self.subTest(bad=bad, pos=pos):
+                    with self.assertRaises(error):
+                        datetime_fromisoformat_many(strs[:pos] + [bad] + strs[pos:], threads=4)
+
+        # The first failure is raised, as when parsing on a single thread
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_many(strs + ['2014-02-05X', None], threads=4)
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat_many(strs + [None, '2014-02-05X'], threads=4)
+
+        with self.assertRaises(ValueError):
+            date_fromisoformat_many(['2014-02-05'], threads=0)
+        with self.assertRaises(TypeError):
+            time_fromisoformat_many(None, threads=2)
+
+
+class TestFixedOffset(unittest.TestCase):
+    def test_offsets_are_shared(self):
+        for tz in ['+05:30', '-23:59', 'Z', '+00:00', '+01:02:03', '-00:00:01']:
+            with self.subTest(tz=tz):
+                dt1 = datetime_fromisoformat('2014-02-05T23:45' + tz)
+                dt2 = datetime_fromisoformat('2019-11-01T01:02:03' + tz)
+                self.assertIs(dt1.tzinfo, dt2.tzinfo)
+                self.assertIsInstance(dt1.tzinfo, FixedOffset)
+
+    def test_sub_minute_offset_eviction(self):
+        # Offsets that collide in the sub-minute cache must not be confused
+        offsets = [1, 65, 129, 3601, 86399]
+        for _ in range(2):
+            for offset in offsets:
+                for sign in [1, -1]:
+                    tzstr = '%s%02d:%02d:%02d' % ('+' if sign > 0 else '-',
+                                                  offset // 3600, offset // 60 % 60, offset % 60)
+                    tz = time_fromisoformat('12:00:00' + tzstr).tzinfo
+                    self.assertEqual(tz.offset, sign * offset)
+
+    def test_offset_is_immutable(self):
+        tz = datetime_fromisoformat('2014-02-05T23:45+05:30').tzinfo
+        with self.assertRaises(AttributeError):
+            tz.offset = 0
+        self.assertEqual(tz.offset, 5 * 3600 + 30 * 60)
+
+    def test_constructor(self):
+        self.assertEqual(FixedOffset(3600).utcoffset(None), timedelta(hours=1))
+        for bad in [86400, -86400]:
+            with self.assertRaises(ValueError):
+                FixedOffset(bad)
+        with self.assertRaises(TypeError):
+            FixedOffset()
+        with self.assertRaises(TypeError):
+            FixedOffset(3600.0)
+        # Instances are immutable, so the constructor shares them
+        self.assertIs(FixedOffset(3600), datetime_fromisoformat('2014-02-05T23:45+01:00').tzinfo)
+
+    def test_constructor_matches_subclasses(self):
+        # FixedOffset has its own vectorcall, which subclasses don't inherit
+        for args, kwargs in [((2**40,), {}), ((-2**40,), {}), ((2**31,), {}), ((86400,), {}), ((1.0,), {}),
+                             (('1',), {}), ((), {}), ((1, 2), {}), ((), {'offset': 5}), ((1,), {'x': 1})]:
+            with self.subTest(args=args, kwargs=kwargs):
+                with self.assertRaises((TypeError, ValueError, OverflowError)) as expected:
+                    FixedOffset(*args, **kwargs)
+                with self.assertRaises(type(expected.exception)) as actual:
+                    FixedOffsetSubclass(*args, **kwargs)
+                self.assertEqual(str(actual.exception), str(expected.exception))
+        self.assertIn('keyword', str(expected.exception))
+        self.assertEqual(FixedOffsetSubclass(True).offset, FixedOffset(True).offset)
+
+    def test_cached_results(self):
+        tz = FixedOffsetSubclass(-(5 * 3600 + 30 * 60 + 15))
+        self.assertIs(tz.utcoffset(None), tz.utcoffset(None))
+        self.assertEqual(tz.utcoffset(None), -timedelta(hours=5, minutes=30, seconds=15))
+        self.assertIs(tz.tzname(None), tz.tzname(None))
+        self.assertEqual(tz.tzname(None), 'UTC-05:30')
+        self.assertEqual(FixedOffset(0).tzname(None), 'UTC')
+
+    def test_fromutc(self):
+        tz = FixedOffset(3600)
+        delta = tz.utcoffset(None)
+        refcount = sys.getrefcount(delta)
+        for _ in range(10):
+            self.assertEqual(tz.fromutc(datetime(2014, 2, 5, 23, 45, tzinfo=tz)),
+                             datetime(2014, 2, 6, 0, 45, tzinfo=tz))
+        self.assertEqual(sys.getrefcount(delta), refcount)
+
+    def test_equality_and_hash(self):
+        tz = FixedOffset(-1)
+        self.assertEqual(tz, FixedOffsetSubclass(-1))
+        self.assertEqual(hash(tz), hash(FixedOffsetSubclass(-1)))
+        self.assertNotEqual(tz, FixedOffset(1))
+        self.assertNotEqual(tz, timezone(timedelta(seconds=-1)))
+        with self.assertRaises(TypeError):
+            tz < FixedOffset(1)
+        self.assertEqual(len({FixedOffsetSubclass(offset) for offset in [60, 60, -60, 0]}), 3)
+
+    def test_pickle(self):
+        dts = datetime_fromisoformat_many(['2014-02-05T23:45+01:00', '2014-02-05T23:45:01+01:00'])
+        for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+            with self.subTest(protocol=protocol):
+                # Pickled separately, the unpickled tzinfos are still shared
+                dt1, dt2 = [pickle.loads(pickle.dumps(dt, protocol)) for dt in dts]
+                self.assertEqual([dt1, dt2], dts)
+                self.assertIs(dt1.tzinfo, dts[0].tzinfo)
+                self.assertIs(dt2.tzinfo, dts[0].tzinfo)
+        self.assertEqual(FixedOffset(-60).__getinitargs__(), (-60,))
+
+    def test_pickle_subclass(self):
+        tz = FixedOffsetSubclass(-60)
+        tz.name = 'x'
+        tz2 = pickle.loads(pickle.dumps(tz))
+        self.assertIsNot(tz2, tz)
+        self.assertIs(type(tz2), FixedOffsetSubclass)
+        self.assertEqual((tz2.offset, tz2.name), (-60, 'x'))
+
+
+class FixedOffsetSubclass(FixedOffset):
+    pass
+
+
+class TestTimezoneMode(unittest.TestCase):
+    def setUp(self):
+        self.addCleanup(set_timezone_mode, get_timezone_mode())
+
+    def test_default_mode(self):
+        self.assertEqual(get_timezone_mode(), 'fixed_offset')
+        self.assertIsInstance(datetime_fromisoformat('2014-02-05T23:45Z').tzinfo, FixedOffset)
+
+    def test_utc_mode(self):
+        set_timezone_mode('utc')
+        self.assertEqual(get_timezone_mode(), 'utc')
+
+        for dtstr in ['2014-02-05T23:45Z', '2014-02-05T23:45+00:00', '2014-02-05T23:45-0000']:
+            with self.subTest(dtstr=dtstr):
+                self.assertIs(datetime_fromisoformat(dtstr).tzinfo, timezone.utc)
+
+        self.assertIs(time_fromisoformat('23:45Z').tzinfo, timezone.utc)
+
+        tz = datetime_fromisoformat('2014-02-05T23:45+05:30').tzinfo
+        self.assertIsInstance(tz, FixedOffset)
+        self.assertEqual(tz.offset, 5 * 3600 + 30 * 60)
+
+    def test_timezone_mode(self):
+        set_timezone_mode('timezone')
+
+        self.assertIs(datetime_fromisoformat('2014-02-05T23:45Z').tzinfo, timezone.utc)
+
+        offsets = [timedelta(hours=5, minutes=30), -timedelta(hours=23, minutes=59)]
+        if sys.version_info >= (3, 7):
+            offsets.append(timedelta(hours=1, minutes=2, seconds=3))
+
+        for offset in offsets:
+            dt = datetime(2014, 2, 5, 23, 45, 12, tzinfo=timezone(offset))
+            with self.subTest(dtstr=dt.isoformat()):
+                dt_rt = datetime_fromisoformat(dt.isoformat())
+                self.assertEqual(dt_rt, dt)
+                self.assertEqual(dt_rt.tzinfo, timezone(offset))
+                self.assertIs(dt_rt.tzinfo, datetime_fromisoformat(dt.isoformat()).tzinfo)
+
+    def test_invalid_mode(self):
+        with self.assertRaises(ValueError):
+            set_timezone_mode('pytz')
+        with self.assertRaises(TypeError):
+            set_timezone_mode(None)
+        self.assertEqual(get_timezone_mode(), 'fixed_offset')
+
+
+class TestBytesInput(unittest.TestCase):
+    def test_bytes_like(self):
+        cases = [
+            (date_fromisoformat, ['2014-02-05', '20140205', '2025-W01-4']),
+            (time_fromisoformat, ['23:45', 'T23:45:12.123456', '12:00:00+05:30', '00:00Z']),
+            (datetime_fromisoformat, ['2014-02-05T23:45', '2014-02-05 23:45:12.123Z',
+                                      '2025W014T1200-0130', '2018-01-31時23:59:47.124789']),
+        ]
+
+        for parse, strs in cases:
+            for s in strs:
+                expected = parse(s)
+                b = s.encode('utf-8')
+                # The memoryview slices are not NUL-terminated
+                for arg in [b, bytearray(b), memoryview(b), memoryview(b'0' + b + b'0')[1:-1]]:
+                    with self.subTest(parse=parse.__name__, arg=arg):
+                        self.assertEqual(parse(arg), expected)
+
+    def test_bytes_like_fails(self):
+        bad_strs = [
+            b'', b'2014-0', b'2014-02-05T', b'2014-02-05T23:45:1',
+            b'2014-02-05\xe6\x99', b'2014-02-05T23:45Z0', b'12:30:45.123456+',
+        ]
+
+        for bad_str in bad_strs:
+            for parse in [date_fromisoformat, time_fromisoformat, datetime_fromisoformat]:
+                # Parsing a truncated view must not read past its end
+                view = memoryview(bad_str + b'00')[:len(bad_str)]
+                with self.subTest(parse=parse.__name__, bad_str=bad_str):
+                    with self.assertRaises(ValueError):
+                        parse(view)
+
+    def test_stdlib_methods_only_accept_str(self):
+        if sys.version_info < (3, 11):
+            for cls in [date, time, datetime]:
+                with self.assertRaises(TypeError):
+                    cls.fromisoformat(b'2014-02-05')
+
+        for parse in [date_fromisoformat, time_fromisoformat, datetime_fromisoformat]:
+            with self.assertRaises(TypeError):
+                parse(None)
+
+
+class TestStrKinds(unittest.TestCase):
+    def test_separators_of_every_kind(self):
+        # Latin-1, UCS-2 and UCS-4 strings are parsed without being encoded
+        for sep in ['\xe9', '\u6642', '\U0001f40d', '\ud800']:
+            for s in ['2018-01-31{}23:59:47.124789+01:00', '2025W014{}1200Z']:
+                s = s.format(sep)
+                with self.subTest(s=ascii(s)):
+                    self.assertEqual(datetime_fromisoformat(s),
+                                     datetime_fromisoformat(s.replace(sep, 'T')))
+
+    def test_non_ascii_fails(self):
+        bad_strs = [
+            (date_fromisoformat, ['2018-01-3\xe9', '2018013\u6642', '2018-01-01\ud800']),
+            (time_fromisoformat, ['12:3\xe9', '12\u6642+01:00', '12:30\ud800']),
+            (datetime_fromisoformat, ['2018-01-31T12:3\xe9', '2018-01-31T12\U0001f40d+01:00',
+                                      '2018-01-31T12:30\ud800', '2018-01-31\ud80012\ud800']),
+        ]
+
+        for parse, strs in bad_strs:
+            for bad_str in strs:
+                with self.subTest(parse=parse.__name__, bad_str=ascii(bad_str)):
+                    with self.assertRaises(ValueError):
+                        parse(bad_str)
+
+
+class TestCanonicalShapes(unittest.TestCase):
+    def test_canonical_shapes(self):
+        tz = pytz.FixedOffset(-(5 * 60 + 30))
+        cases = [
+            ('2014-02-05T23:45:12', datetime(2014, 2, 5, 23, 45, 12)),
+            ('2014-02-05 23:45:12Z', datetime(2014, 2, 5, 23, 45, 12, tzinfo=pytz.utc)),
+            ('2014-02-05T23:45:12-05:30', datetime(2014, 2, 5, 23, 45, 12, tzinfo=tz)),
+            ('2014-02-05T23:45:12.123456', datetime(2014, 2, 5, 23, 45, 12, 123456)),
+            ('2014-02-05\x0023:45:12.000001Z', datetime(2014, 2, 5, 23, 45, 12, 1, tzinfo=pytz.utc)),
+            ('2014-02-05T23:45:12.123456-05:30', datetime(2014, 2, 5, 23, 45, 12, 123456, tzinfo=tz)),
+        ]
+
+        for s, expected in cases:
+            for arg in [s, s.encode('utf-8')]:
+                with self.subTest(arg=arg):
+                    self.assertEqual(datetime_fromisoformat(arg), expected)
+
+    def test_near_canonical_shapes(self):
+        # Strings with the length of a canonical shape, but another format
+        cases = [
+            ('2014-02-05T23:45:12,123456', datetime(2014, 2, 5, 23, 45, 12, 123456)),
+            ('2014-02-05T23:45:12+05:30Z', None),
+            ('2014-02-05T23:45:12,05:30', None),
+            ('2014-02-05T23:45:1A', None),
+            ('2014-02-05T23:45:12.1234-5', None),
+            ('20140205T234512.123456Z', datetime(2014, 2, 5, 23, 45, 12, 123456, tzinfo=pytz.utc)),
+            ('2014-02-05T23:45:60', None),
+        ]
+
+        for s, expected in cases:
+            with self.subTest(s=s):
+                if expected is None:
+                    with self.assertRaises(ValueError):
+                        datetime_fromisoformat(s)
+                else:
+                    self.assertEqual(datetime_fromisoformat(s), expected)
+
+
+    def test_fixed_length_shapes(self):
+        tz = pytz.FixedOffset(5 * 60 + 30)
+        cases = [
+            (date_fromisoformat, '2014-02-05', date(2014, 2, 5)),
+            (datetime_fromisoformat, '2014-02-05', datetime(2014, 2, 5)),
+            (datetime_fromisoformat, '2014-02-05T23:45', datetime(2014, 2, 5, 23, 45)),
+            (datetime_fromisoformat, '2014-02-05T23:45:12.123', datetime(2014, 2, 5, 23, 45, 12, 123000)),
+            (datetime_fromisoformat, '2014-02-05T23:45:12.123Z',
+             datetime(2014, 2, 5, 23, 45, 12, 123000, tzinfo=pytz.utc)),
+            (datetime_fromisoformat, '2014-02-05\u664223:45:12.123+05:30',
+             datetime(2014, 2, 5, 23, 45, 12, 123000, tzinfo=tz)),
+            (time_fromisoformat, '23:45', time(23, 45)),
+            (time_fromisoformat, 'T23:45:12', time(23, 45, 12)),
+            (time_fromisoformat, '23:45:12.123456', time(23, 45, 12, 123456)),
+            (time_fromisoformat, '23:45:12.123+05:30', time(23, 45, 12, 123000, tzinfo=tz)),
+            (time_fromisoformat, '23:45Z', time(23, 45, tzinfo=pytz.utc)),
+            # Same lengths as the fixed shapes, in other formats
+            (date_fromisoformat, '2014-W06-3', date(2014, 2, 5)),
+            (time_fromisoformat, '234512,123', time(23, 45, 12, 123000)),
+            (time_fromisoformat, '23:45:12.1-05', time(23, 45, 12, 100000, tzinfo=pytz.FixedOffset(-5 * 60))),
+            (datetime_fromisoformat, '2014-02-05T2345+0530', datetime(2014, 2, 5, 23, 45, tzinfo=tz)),
+        ]
+
+        for parse, s, expected in cases:
+            with self.subTest(parse=parse.__name__, s=s):
+                self.assertEqual(parse(s), expected)
+
+
+class TestToEpoch(unittest.TestCase):
+    EPOCH = datetime(1970, 1, 1, tzinfo=pytz.utc)
+
+    def test_to_epoch(self):
+        strs = [
+            '1970-01-01', '2014-02-05T23:45:12.123456', '2014-02-05 23:45:12Z',
+            '2014-02-05T23:45:12.123-05:30', '2025W014T1200+0130', '1969-12-31T23:59:59.999999Z',
+            '0001-01-01T00:00:00+23:59', '9999-12-31T23:59:59.999999-23:59',
+        ]
+
+        for s in strs:
+            dt = datetime_fromisoformat(s)
+            if dt.tzinfo is None:
+                dt = dt.replace(tzinfo=pytz.utc)
+            expected = (dt - self.EPOCH) // timedelta(microseconds=1)
+            for arg in [s, s.encode('utf-8')]:
+                with self.subTest(arg=arg):
+                    self.assertEqual(datetime_fromisoformat_to_epoch(arg), expected)
+                    self.assertEqual(datetime_fromisoformat_to_epoch(arg, unit='ns'), expected * 1000)
+
+    def test_nanoseconds(self):
+        cases = [
+            ('1970-01-01T00:00:00.123456789', 123456, 123456789),
+            ('1970-01-01T00:00:00.1234567', 123456, 123456700),
+            ('1970-01-01T00:00:00,12345678912Z', 123456, 123456789),
+            ('1969-12-31T23:59:59.9999999Z', -1, -100),
+            ('1970-01-01T01:00:00.000000001+01:00', 0, 1),
+            ('9999-12-31T23:59:59.999999999', 253402300799999999, 253402300799999999999),
+        ]
+
+        for s, us, ns in cases:
+            with self.subTest(s=s):
+                self.assertEqual(datetime_fromisoformat_to_epoch(s), us)
+                self.assertEqual(datetime_fromisoformat_to_epoch(s, unit='ns'), ns)
+
+    def test_to_epoch_fails(self):
+        for bad_str in ['', '2014-02-05T', '2014-13-05', '2014-02-30T12:00', '2014-02-05T24:00',
+                        '2014-02-05T12:00+24:00', '2014-02-05T12:00\ud800']:
+            with self.subTest(bad_str=ascii(bad_str)):
+                with self.assertRaises(ValueError):
+                    datetime_fromisoformat_to_epoch(bad_str)
+
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_to_epoch('2014-02-05', unit='ms')
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat_to_epoch(None)
+
+
+class TestToDays(unittest.TestCase):
+    def test_to_days(self):
+        strs = ['1970-01-01', '2014-02-05', None, 'garbage', '2014-02-30', b'20140205',
+                '2020-W01-1', '0001-01-01', '9999-12-31', '2014-02-05\ud800']
+        valid = [s is not None and s not in ('garbage', '2014-02-30', '2014-02-05\ud800') for s in strs]
+
+        out, validity = date_fromisoformat_to_days(strs)
+        self.assertIsInstance(out, array.array)
+        self.assertEqual(out.typecode, 'i')
+        self.assertEqual(len(validity), 2)
+
+        epoch = date(1970, 1, 1).toordinal()
+        for i, (s, is_valid) in enumerate(zip(strs, valid)):
+            with self.subTest(s=s):
+                self.assertEqual(bool(validity[i // 8] & (1 << (i % 8))), is_valid)
+                expected = date_fromisoformat(s).toordinal() - epoch if is_valid else 0
+                self.assertEqual(out[i], expected)
+
+        out, _ = date_fromisoformat_to_days(['2014-02-05', '0001-01-01'], ordinal=True)
+        self.assertEqual(list(out), [date(2014, 2, 5).toordinal(), 1])
+
+    def test_to_days_buffers(self):
+        out = array.array('i', [-1] * 3)
+        validity = bytearray(b'\xff')
+        result = date_fromisoformat_to_days(['1970-01-02', 'x', '1969-12-31'], out=out, validity=validity)
+        self.assertIs(result[0], out)
+        self.assertIs(result[1], validity)
+        self.assertEqual(list(out), [1, 0, -1])
+        self.assertEqual(validity, bytearray(b'\x05'))
+
+        with self.assertRaises(ValueError):
+            date_fromisoformat_to_days(['1970-01-02', '1970-01-03'], out=bytearray(7))
+        with self.assertRaises(ValueError):
+            date_fromisoformat_to_days(['1970-01-02'] * 9, validity=bytearray(1))
+        with self.assertRaises(BufferError):
+            date_fromisoformat_to_days(['1970-01-02'], out=b'\0' * 4)
+        with self.assertRaises(TypeError):
+            date_fromisoformat_to_days([1])
+
+    def test_to_days_threads(self):
+        strs = ['1970-01-01', '2014-02-05', None, 'garbage', '2014-02-30', b'20140205',
+                bytearray(b'2020-W01-1'), '2014\u221202-05', '9999-12-31', '2014-02-05\ud800'] * 3001
+        self.assertEqual(date_fromisoformat_to_days(strs, threads=4), date_fromisoformat_to_days(strs))
+
+        with self.assertRaises(ValueError):
+            date_fromisoformat_to_days(strs, threads=0)
+        with self.assertRaises(TypeError):
+            date_fromisoformat_to_days(strs + [1], threads=4)
+
+
+class ArrowSchema(ctypes.Structure):
+    _fields_ = [('format', ctypes.c_char_p), ('name', ctypes.c_char_p), ('metadata', ctypes.c_char_p),
+                ('flags', ctypes.c_int64), ('n_children', ctypes.c_int64), ('children', ctypes.c_void_p),
+                ('dictionary', ctypes.c_void_p), ('release', ctypes.c_void_p), ('private_data', ctypes.c_void_p)]
+
+
+class ArrowArray(ctypes.Structure):
+    _fields_ = [('length', ctypes.c_int64), ('null_count', ctypes.c_int64), ('offset', ctypes.c_int64),
+                ('n_buffers', ctypes.c_int64), ('n_children', ctypes.c_int64),
+                ('buffers', ctypes.POINTER(ctypes.c_void_p)), ('children', ctypes.c_void_p),
+                ('dictionary', ctypes.c_void_p), ('release', ctypes.c_void_p), ('private_data', ctypes.c_void_p)]
+
+
+_PyCapsule_New = ctypes.pythonapi.PyCapsule_New
+_PyCapsule_New.restype = ctypes.py_object
+_PyCapsule_New.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+_ARROW_RELEASE = ctypes.CFUNCTYPE(None, ctypes.c_void_p)(lambda _: None)
+
+
+class ArrowStringArray(object):
+    """A minimal producer of the Arrow PyCapsule interface, for an array of (large) strings"""
+
+    def __init__(self, strings, large=False, offset=0):
+        data = b''.join(s.encode('utf-8') if s is not None else b'' for s in strings)
+        offsets = [0]
+        for s in strings:
+            offsets.append(offsets[-1] + (len(s.encode('utf-8')) if s is not None else 0))
+        validity = bytearray((len(strings) + 7) // 8)
+        for i, s in enumerate(strings):
+            if s is not None:
+                validity[i // 8] |= 1 << (i % 8)
+
+        # The buffers are kept alive by this object
+        self._data = ctypes.create_string_buffer(data)
+        self._offsets = ((ctypes.c_int64 if large else ctypes.c_int32) * len(offsets))(*offsets)
+        self._validity = (ctypes.c_uint8 * len(validity))(*validity)
+        self._buffers = (ctypes.c_void_p * 3)(ctypes.addressof(self._validity),
+                                              ctypes.addressof(self._offsets),
+                                              ctypes.addressof(self._data))
+
+        release = ctypes.cast(_ARROW_RELEASE, ctypes.c_void_p)
+        self.schema = ArrowSchema(format=b'U' if large else b'u', release=release)
+        self.array = ArrowArray(length=len(strings) - offset, offset=offset, n_buffers=3,
+                                buffers=self._buffers, release=release)
+
+    def __arrow_c_array__(self, requested_schema=None):
+        return (_PyCapsule_New(ctypes.addressof(self.schema), b'arrow_schema', None),
+                _PyCapsule_New(ctypes.addressof(self.array), b'arrow_array', None))
+
+
+class TestArrow(unittest.TestCase):
+    STRS = ['1970-01-01', None, '2014-02-05T23:45:12.123456789+05:30', 'garbage', '2014-02-30',
+            '2025W014T1200Z', '2018-01-31\u664223:59:47.124789', '0001-01-01T00:00', '2014-02-05T12:00+24:00']
+
+    def test_to_epoch_arrow(self):
+        for large in [False, True]:
+            for offset in [0, 3]:
+                strs = self.STRS[offset:]
+                for unit in ['us', 'ns']:
+                    with self.subTest(large=large, offset=offset, unit=unit):
+                        array = ArrowStringArray(self.STRS, large=large, offset=offset)
+                        out, validity = datetime_fromisoformat_to_epoch_arrow(array, unit=unit)
+                        self.assertEqual(out.typecode, 'q')
+                        self.assertEqual(len(out), len(strs))
+
+                        for i, s in enumerate(strs):
+                            try:
+                                expected = datetime_fromisoformat_to_epoch(s, unit=unit)
+                                if not -2 ** 63 <= expected < 2 ** 63:
+                                    expected = None
+                            except (TypeError, ValueError):
+                                expected = None
+
+                            self.assertEqual(bool(validity[i // 8] & (1 << (i % 8))), expected is not None)
+                            self.assertEqual(out[i], expected or 0)
+
+    def test_to_epoch_arrow_buffers(self):
+        out = array.array('q', [-1] * 2)
+        validity = bytearray(b'\xff')
+        result = datetime_fromisoformat_to_epoch_arrow(ArrowStringArray(['1970-01-01T00:00:01', None]),
+                                                       out=out, validity=validity)
+        self.assertIs(result[0], out)
+        self.assertIs(result[1], validity)
+        self.assertEqual(list(out), [1000000, 0])
+        self.assertEqual(validity, bytearray(b'\x01'))
+
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_to_epoch_arrow(ArrowStringArray(['1970-01-01']), out=bytearray(7))
+
+    def test_to_epoch_arrow_threads(self):
+        for offset in [0, 3]:
+            with self.subTest(offset=offset):
+                array = ArrowStringArray(self.STRS * 1001, offset=offset)
+                self.assertEqual(datetime_fromisoformat_to_epoch_arrow(array, threads=4),
+                                 datetime_fromisoformat_to_epoch_arrow(array))
+
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_to_epoch_arrow(ArrowStringArray(['1970-01-01']), threads=0)
+
+    def test_to_epoch_arrow_fails(self):
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat_to_epoch_arrow(['1970-01-01'])
+
+        array = ArrowStringArray(['1970-01-01'])
+        array.schema.format = b'i'
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat_to_epoch_arrow(array)
+
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_to_epoch_arrow(ArrowStringArray(['1970-01-01']), unit='s')
+
+    def test_to_epoch_arrow_malformed(self):
+        # Offsets that decrease, or that don't start at 0 or more
+        for large in [False, True]:
+            for offsets in [(0, 10, 5), (-1, 10, 20), (0, 2**31 - 1, 0)]:
+                with self.subTest(large=large, offsets=offsets):
+                    array = ArrowStringArray(['1970-01-01', '1970-01-02'], large=large)
+                    array._offsets[:] = offsets
+                    with self.assertRaises(ValueError):
+                        datetime_fromisoformat_to_epoch_arrow(array)
+
+        for field, value in [('length', -1), ('offset', -1), ('offset', 2**63 - 1)]:
+            with self.subTest(field=field, value=value):
+                array = ArrowStringArray(['1970-01-01'])
+                setattr(array.array, field, value)
+                with self.assertRaises(ValueError):
+                    datetime_fromisoformat_to_epoch_arrow(array)
+
+        array = ArrowStringArray(['1970-01-01'])
+        array._buffers[2] = None
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_to_epoch_arrow(array)
+        array = ArrowStringArray(['', ''])
+        array._buffers[2] = None
+        self.assertEqual(list(datetime_fromisoformat_to_epoch_arrow(array)[0]), [0, 0])
+
+
+class TestPrefix(unittest.TestCase):
+    def test_prefix(self):
+        cases = [
+            ('2014-02-05T23:45:12.123456+05:30 INFO started', 0, 32),
+            ('2014-02-05 23:45:12 INFO started', 0, 19),
+            ('[2014-02-05T23:45:12Z] started', 1, 21),
+            ('2014-02-05 started', 0, 10),
+            ('2025W014T1200-0130: started', 0, 18),
+            ('2014-02-05T23:45:12,5- started', 0, 21),
+            ('2014-02-05T23:45:1299 started', 0, 19),
+            ('2014-02-05T23:95 started', 0, 13),
+            ('2018-01-31\u664223:59:47.124789 \u6642', 0, 26),
+            ('2014-02-05T23:45', 0, 16),
+            (b'2014-02-05\xc3\xa923:45 started', 0, 17),
+            (bytearray(b'x 2014-02-05T23:45'), 2, 18),
+        ]
+
+        for s, pos, end in cases:
+            with self.subTest(s=s, pos=pos):
+                self.assertEqual(parse_isoformat_prefix(s, pos), (datetime_fromisoformat(s[pos:end]), end))
+
+        self.assertEqual(parse_isoformat_prefix('2014-02-05T23:45 x', pos=0), (datetime(2014, 2, 5, 23, 45), 16))
+
+    def test_prefix_long_runs(self):
+        cases = [
+            ('2014-02-05T' + '12:' * 40, 22),
+            ('2014-02-05T23:45:12.' + '1' * 100 + 'x', 120),
+            ('2014-02-05T23:45:12.123456' + '12:' * 40 + '+05:30 x', 152),
+            ('2014-02-05T23:45' + '+1' * 40, 16),
+            ('2020W01' + '1' * 100 + '99', 109),
+            ('2020W01' + '1' * 100 + '9', 108),
+        ]
+        for s, end in cases:
+            with self.subTest(s=s):
+                self.assertEqual(parse_isoformat_prefix(s), (datetime_fromisoformat(s[:end]), end))
+
+        # Lines of untrusted input: the time taken must be linear in their length
+        for make in [lambda n: '2014-02-05T' + '12:' * n,
+                     lambda n: '2014-13-05T23:45:12.' + '1' * n,
+                     lambda n: '2014-02-05T23:45:12.123456' + '12:' * n + '+05:30:' + '1' * n]:
+            timings = []
+            for n in (2000, 32000):
+                s = make(n)
+                timings.append(min(timeit.repeat(lambda: parse_isoformat_prefix(s, errors='coerce'), number=1,
+                                                 repeat=5)))
+            self.assertLess(timings[1], 64 * timings[0] + 0.001)
+
+    def test_prefix_fails(self):
+        for s, pos in [('', 0), ('2014-02 INFO', 0), ('x2014-02-05', 0), ('2014-02-05', 10), ('2014-13-01', 0)]:
+            with self.subTest(s=s, pos=pos):
+                with self.assertRaises(ValueError):
+                    parse_isoformat_prefix(s, pos)
+
+        with self.assertRaises(IndexError):
+            parse_isoformat_prefix('2014-02-05', 11)
+        with self.assertRaises(IndexError):
+            parse_isoformat_prefix('2014-02-05', -1)
+        with self.assertRaises(TypeError):
+            parse_isoformat_prefix(None)
+
+
+class TestLines(unittest.TestCase):
+    def write_file(self, contents):
+        fd, path = tempfile.mkstemp()
+        self.addCleanup(os.remove, path)
+        with os.fdopen(fd, 'wb') as f:
+            f.write(contents)
+        return path
+
+    def test_lines(self):
+        strs = ['2014-02-05T23:45:12.123456+05:30', '2014-02-05 23:45', '2025W014T1200Z',
+                '2018-01-31\u664223:59:47.124789'] * 1000
+        path = self.write_file(''.join('  %s\r\n\n' % s for s in strs).encode('utf-8'))
+        expected = [datetime_fromisoformat(s) for s in strs]
+
+        for chunk_size, threads in [(65536, 1), (7, 1), (1, 1), (4000, 4)]:
+            with self.subTest(chunk_size=chunk_size, threads=threads):
+                chunks = list(datetime_fromisoformat_lines(path, chunk_size=chunk_size, threads=threads))
+                self.assertTrue(all(0 < len(chunk) <= chunk_size for chunk in chunks))
+                self.assertEqual(list(itertools.chain.from_iterable(chunks)), expected)
+
+        # A file descriptor, and a last line without a newline
+        path = self.write_file(b'2014-02-05T23:45\n2014-02-06T00:00')
+        fd = os.open(path, os.O_RDONLY)
+        self.addCleanup(os.close, fd)
+        self.assertEqual(list(datetime_fromisoformat_lines(fd)),
+                         [[datetime(2014, 2, 5, 23, 45), datetime(2014, 2, 6)]])
+
+    def test_lines_empty(self):
+        for contents in [b'', b'\n \n']:
+            with self.subTest(contents=contents):
+                self.assertEqual(list(datetime_fromisoformat_lines(self.write_file(contents))), [])
+
+    def test_lines_fails(self):
+        path = self.write_file(b'2014-02-05T23:45\n2014-02-05X\n')
+        with self.assertRaisesRegex(ValueError, re.escape("b'2014-02-05X'")):
+            list(datetime_fromisoformat_lines(path))
+
+        with self.assertRaises(OSError):
+            datetime_fromisoformat_lines(path + '.missing')
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_lines(path, chunk_size=0)
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_lines(path, threads=0)
+
+    def test_lines_fails_stops(self):
+        # Lines that were never returned are not skipped over by resuming
+        path = self.write_file(b'2014-02-05T01:00\nbad\n2014-02-05T02:00\n'
+                               b'2014-02-05T03:00\n2014-02-05T04:00\n')
+        lines = datetime_fromisoformat_lines(path, chunk_size=3)
+        with self.assertRaises(ValueError):
+            next(lines)
+        self.assertEqual(list(lines), [])
+
+    def test_lines_cycle(self):
+        default = Holder()
+        default.lines = datetime_fromisoformat_lines(self.write_file(b'x\n'), errors='default', default=default)
+        ref = weakref.ref(default)
+        del default
+        gc.collect()
+        self.assertIsNone(ref())
+
+
+class TestErrors(unittest.TestCase):
+    invalid = ['', '2014-13-01', '2014-02-30T12:00', '2014-02-05T24:01', '2014-02-05T23:45+24:00',
+               '2014-02-0\ud800', '2014-02-05X']
+
+    def test_errors_single(self):
+        for func in [date_fromisoformat, time_fromisoformat, datetime_fromisoformat]:
+            for s in self.invalid + ['25:00', '12:00+24:00', b'2014-02-05\xff']:
+                with self.subTest(func=func, s=s):
+                    with self.assertRaises(ValueError):
+                        func(s)
+                    self.assertIsNone(func(s, errors='coerce'))
+                    name = 'time_string' if func is time_fromisoformat else 'date_string'
+                    self.assertIs(func(**{name: s}, errors='default', default=Ellipsis), Ellipsis)
+
+            # Valid strings are unaffected
+            s = {date_fromisoformat: '2014-02-05', time_fromisoformat: '23:45'}.get(func, '2014-02-05T23:45')
+            self.assertEqual(func(s, errors='coerce'), func(s))
+            self.assertEqual(func(s, errors='raise'), func(s))
+
+    def test_errors_many(self):
+        strs = ['2014-02-05T23:45'] + self.invalid
+        for threads in [1, 4]:
+            with self.subTest(threads=threads):
+                self.assertEqual(datetime_fromisoformat_many(strs * 3000, threads=threads, errors='coerce'),
+                                 ([datetime(2014, 2, 5, 23, 45)] + [None] * (len(strs) - 1)) * 3000)
+                self.assertEqual(date_fromisoformat_many(['2014-02-05', 'x'], threads=threads, errors='default',
+                                                         default=0),
+                                 [date(2014, 2, 5), 0])
+
+    def test_errors_others(self):
+        self.assertIsNone(datetime_fromisoformat_to_epoch('2014-13-01', errors='coerce'))
+        self.assertEqual(datetime_fromisoformat_to_epoch('x', 'ns', errors='default', default=-1), -1)
+        self.assertIsNone(parse_isoformat_prefix('x2014-02-05', errors='coerce'))
+
+        fd, path = tempfile.mkstemp()
+        self.addCleanup(os.remove, path)
+        with os.fdopen(fd, 'wb') as f:
+            f.write(b'2014-02-05T23:45\n2014-02-05X\n')
+        self.assertEqual(list(datetime_fromisoformat_lines(path, errors='coerce')),
+                         [[datetime(2014, 2, 5, 23, 45), None]])
+
+    def test_errors_fails(self):
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat('2014-02-05', errors='ignore')
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat('2014-02-05', errors=None)
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat('2014-02-05', errors='coerce', bad=1)
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat('2014-02-05', date_string='2014-02-05')
+        with self.assertRaises(TypeError):
+            time_fromisoformat(date_string='23:45')
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat('2014-02-05', 'coerce')
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat()
+        with self.assertRaises(TypeError):
+            datetime_fromisoformat(None, errors='coerce')
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_many(['2014-02-05'], errors='ignore')
+
+
+class TestArguments(unittest.TestCase):
+    def test_keyword_args(self):
+        s = '2014-02-05T23:45'
+        dt = datetime(2014, 2, 5, 23, 45)
+        self.assertEqual(datetime_fromisoformat_to_epoch(s, 'ns'), datetime_fromisoformat_to_epoch(s, unit='ns'))
+        self.assertEqual(parse_isoformat_prefix('x' + s, 1), parse_isoformat_prefix(date_string='x' + s, pos=1))
+        self.assertEqual(datetime_fromisoformat_many(iterable=[s], threads=2, default=0), [dt])
+        self.assertEqual(date_fromisoformat_to_days(['1970-01-02'], None, None, True),
+                         date_fromisoformat_to_days(strings=['1970-01-02'], ordinal=True))
+        # Keywords that aren't interned, eg. built at runtime
+        self.assertIsNone(datetime_fromisoformat('x', **{''.join(['err', 'ors']): 'coerce'}))
+
+    def test_keyword_args_fails(self):
+        s = '2014-02-05T23:45'
+        for call in [lambda: datetime_fromisoformat_to_epoch(s, 'us', 'coerce'),
+                     lambda: datetime_fromisoformat_to_epoch(s, 1),
+                     lambda: parse_isoformat_prefix(s, 0, pos=0),
+                     lambda: parse_isoformat_prefix(s, 0.0),
+                     lambda: datetime_fromisoformat_many([s], threads=1.0),
+                     lambda: datetime_fromisoformat_many([s], iterable=[s]),
+                     lambda: datetime_fromisoformat_many(threads=1),
+                     lambda: date_fromisoformat_to_days(['1970-01-01'], threads=1, bad=1),
+                     lambda: set_result_cache()]:
+            with self.assertRaises(TypeError):
+                call()
+        with self.assertRaises(ValueError):
+            datetime_fromisoformat_to_epoch(s, unit='ms')
+        with self.assertRaises(OverflowError):
+            datetime_fromisoformat_many([s], threads=2 ** 40)
+
+
+class TestFields(unittest.TestCase):
+    def test_fields(self):
+        for s in ['2014-02-05', '2014-W06-3T23:45', '2014-02-05T23:45:12.123456', b'2014-02-05 23:45:12Z',
+                  '2014-02-05T23:45:12.5+05:30', '2014-02-05T23:45-00:00:59', '20140205T234512.1-0300']:
+            with self.subTest(s=s):
+                dt = datetime_fromisoformat(s)
+                fields = parse_isoformat_fields(s)
+                self.assertIsInstance(fields, IsoformatFields)
+                self.assertEqual(fields[:7], (dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second,
+                                              dt.microsecond))
+                self.assertIs(fields.has_offset, dt.tzinfo is not None)
+                offset = dt.utcoffset() or timedelta(0)
+                self.assertEqual(fields.offset_seconds, offset // timedelta(seconds=1))
+                self.assertEqual(fields.offset_microseconds, 0)
+
+    def test_fields_offset_microseconds(self):
+        fields = parse_isoformat_fields('2014-02-05T23:45-03:00:01.000017')
+        self.assertEqual(fields, (2014, 2, 5, 23, 45, 0, 0, -10801, -17, True))
+        self.assertEqual(pickle.loads(pickle.dumps(fields)), fields)
+
+    def test_fields_errors(self):
+        for s in ['2014-02-30', '2014-02-05T24:01', '2014-02-05T12:00+24:00', 'x']:
+            with self.subTest(s=s):
+                with self.assertRaises(ValueError):
+                    parse_isoformat_fields(s)
+                self.assertIsNone(parse_isoformat_fields(s, errors='coerce'))
+                self.assertEqual(parse_isoformat_fields(s, errors='default', default=0), 0)
+        with self.assertRaises(TypeError):
+            parse_isoformat_fields(1)
+
+
+class TestValidation(unittest.TestCase):
+    STRINGS = ['2014-02-05', '2014-W06-3', '20140205', '2014-02-30', '2014-13-05', '23:45', '23:45:12.123+05:30',
+               '24:00', '23:45+24:00', '2014-02-05T23:45', '2014-02-05 23:45:12Z', '2014-02-05\xe923:45',
+               '2014-02-05\ud80023:45', '2014-02-30T23:45', '2014-02-05T23:45+25:00', '', 'x', '\xe9\ud800',
+               b'2014-02-05', b'2014-02-05T23:45', bytearray(b'23:45'), memoryview(b'2014-02-30')]
+
+    @staticmethod
+    def accepts(func, s):
+        try:
+            func(s)
+        except ValueError:
+            return False
+        return True
+
+    def test_is_isoformat(self):
+        for validate, parse in [(is_isoformat_date, date_fromisoformat), (is_isoformat_time, time_fromisoformat),
+                                (is_isoformat_datetime, datetime_fromisoformat)]:
+            for s in self.STRINGS:
+                with self.subTest(validate=validate.__name__, s=s):
+                    self.assertIs(validate(s), self.accepts(parse, s))
+
+    def test_is_isoformat_many(self):
+        strings = self.STRINGS * 10 + [None]
+        for validate_many, parse in [(is_isoformat_date_many, date_fromisoformat),
+                                     (is_isoformat_time_many, time_fromisoformat),
+                                     (is_isoformat_datetime_many, datetime_fromisoformat)]:
+            expected = [s is not None and self.accepts(parse, s) for s in strings]
+            for threads in (1, 3):
+                validity = validate_many(strings, threads=threads)
+                self.assertEqual(len(validity), (len(strings) + 7) // 8)
+                self.assertEqual([bool(validity[i // 8] >> (i % 8) & 1) for i in range(len(strings))], expected)
+
+        validity = bytearray(b'\xff\xff')
+        self.assertIs(is_isoformat_date_many(['2014-02-05', 'x'], validity), validity)
+        self.assertEqual(validity, b'\x01\xff')
+        self.assertEqual(is_isoformat_date_many([]), b'')
+
+    def test_is_isoformat_fails(self):
+        for call in [lambda: is_isoformat_date(1),
+                     lambda: is_isoformat_datetime(None),
+                     lambda: is_isoformat_time_many(1),
+                     lambda: is_isoformat_datetime_many(['2014-02-05', 1]),
+                     lambda: is_isoformat_date_many(['2014-02-05'], threads='1')]:
+            with self.assertRaises(TypeError):
+                call()
+        with self.assertRaises(ValueError):
+            is_isoformat_date_many(['2014-02-05'] * 9, bytearray(1))
+        with self.assertRaises(ValueError):
+            is_isoformat_date_many([], threads=0)
+
+
+class TestIsoformatMany(unittest.TestCase):
+    def test_isoformat_many(self):
+        tzinfos = [None, FixedOffset(19800), FixedOffset(-5400), FixedOffset(-59), timezone.utc,
+                   timezone(timedelta(hours=-3, seconds=-1, microseconds=-17)), pytz.timezone('Europe/Paris')]
+        dts = [datetime(year, 2, 5, 23, 45, 12, microsecond, tzinfo=tzinfo)
+               for year in (1, 999, 2014) for microsecond in (0, 1500, 123456) for tzinfo in tzinfos]
+        for sep in ('T', ' ', '\xe9'):
+            for timespec in ('auto', 'hours', 'minutes', 'seconds', 'milliseconds', 'microseconds'):
+                for end in ('\n', '', ';\xe9'):
+                    expected = ''.join(dt.isoformat(sep, timespec) + end for dt in dts)
+                    self.assertEqual(isoformat_many(dts, sep, timespec, end=end), expected)
+        self.assertEqual(isoformat_many([]), '')
+        self.assertEqual(isoformat_many(iter(dts[:2])), dts[0].isoformat() + '\n' + dts[1].isoformat() + '\n')
+
+    def test_isoformat_many_out(self):
+        dts = [datetime(2014, 2, 5, 23, 45, tzinfo=FixedOffset(3600)), datetime(2014, 2, 6)]
+        out = bytearray(b'x')
+        self.assertIs(isoformat_many(dts, '\xe9', out=out), out)
+        self.assertEqual(out, 'x2014-02-05\xe923:45:00+01:00\n2014-02-06\xe900:00:00\n'.encode())
+
+        # Left unchanged by errors
+        out = bytearray(b'x')
+        with self.assertRaises(TypeError):
+            isoformat_many(dts + [date(2014, 2, 5)], out=out)
+        self.assertEqual(out, b'x')
+
+    def test_isoformat_many_fails(self):
+        dt = datetime(2014, 2, 5)
+        for call in [lambda: isoformat_many(1),
+                     lambda: isoformat_many(['2014-02-05']),
+                     lambda: isoformat_many([dt], sep='TT'),
+                     lambda: isoformat_many([dt], sep=b'T'),
+                     lambda: isoformat_many([dt], timespec=1),
+                     lambda: isoformat_many([dt], out=b''),
+                     lambda: isoformat_many([dt], end=None)]:
+            with self.assertRaises(TypeError):
+                call()
+        with self.assertRaises(ValueError):
+            isoformat_many([dt], timespec='nanoseconds')
+
+
+class Holder(object):
+    """A default= value that can refer back to what holds it, for cycles."""
+
+
+class TestIncrementalParser(unittest.TestCase):
+    def test_incremental(self):
+        strs = ['2025-W01-4T12:00', '2025-W01-4T12:00:01.5', '2025-W01-4 12:00', '2025-W01-4T25:00',
+                '2025-W01-4T12:00+05:30', '2025-W01-412:00', '2025-W01-40000', '2025-W01-4', '2025-W01-4T',
+                '20140205T2345', '20140205T234512Z', '20140205\xe92345', '2014-02-05T23:45:12.123456+05:30',
+                '2014-02-05T23:45:12.123', '2014-02-05\u664223:45', '2014-02-05\ud80023:45', '2014-02-05T23:45',
+                '2014-02-06T00:00', '2014-02-06T00:0\xe9', '2014-02-06T00:00Z', b'2014-02-06T01:00',
+                b'2014-02-06\xc3\xa901:00', bytearray(b'2014-02-06T01:00:01'), '2025W014T1200', '2025W0141200']
+
+        parser = IncrementalParser()
+        for s in strs * 2:
+            with self.subTest(s=s):
+                try:
+                    expected = datetime_fromisoformat(s)
+                except ValueError:
+                    with self.assertRaises(ValueError):
+                        parser.parse(s)
+                else:
+                    self.assertEqual(parser.parse(s), expected)
+
+    def test_incremental_errors(self):
+        parser = IncrementalParser(errors='coerce')
+        self.assertEqual(parser.parse('2014-02-05T23:45'), datetime(2014, 2, 5, 23, 45))
+        self.assertIsNone(parser.parse('2014-02-05T24:45'))
+        self.assertIsNone(parser.parse('2014-02-30T23:45'))
+        self.assertIs(IncrementalParser(errors='default', default=Ellipsis).parse('x'), Ellipsis)
+
+        with self.assertRaises(TypeError):
+            parser.parse(None)
+        with self.assertRaises(ValueError):
+            IncrementalParser(errors='ignore')
+        with self.assertRaises(TypeError):
+            IncrementalParser('coerce')
+
+    def test_incremental_cycle(self):
+        default = Holder()
+        default.parser = IncrementalParser(errors='default', default=default)
+        ref = weakref.ref(default)
+        del default
+        gc.collect()
+        self.assertIsNone(ref())
+
+
+class TestResultCache(unittest.TestCase):
+    def setUp(self):
+        self.addCleanup(set_result_cache, 0)
+
+    def test_cache(self):
+        self.assertIsNot(date_fromisoformat('2014-02-05'), date_fromisoformat('2014-02-05'))
+
+        set_result_cache(16)
+        d = date_fromisoformat('2014-02-05')
+        self.assertEqual(d, date(2014, 2, 5))
+        self.assertIs(date_fromisoformat('2014-02-05'), d)
+        self.assertIs(date_fromisoformat(b'2014-02-05'), d)
+        self.assertEqual(date_fromisoformat_many(['2014-02-05', '2014-02-06'] * 3000, threads=4),
+                         [d, date(2014, 2, 6)] * 3000)
+        self.assertIsNot(date_fromisoformat('2014-02-05\u00e9', errors='coerce'), d)
+
+        # Datetimes and times aren't cached by default
+        self.assertIsNot(datetime_fromisoformat('2014-02-05'), datetime_fromisoformat('2014-02-05'))
+        self.assertIsNot(time_fromisoformat('12:00'), time_fromisoformat('12:00'))
+
+        # Neither are invalid strings
+        self.assertIsNone(date_fromisoformat('2014-02-30', errors='coerce'))
+        with self.assertRaises(ValueError):
+            date_fromisoformat('2014-02-30')
+
+        info = get_result_cache_info()
+        self.assertEqual(info['maxsize'], 16)
+        self.assertEqual(info['currsize'], 2)
+        self.assertFalse(info['datetimes'])
+        self.assertEqual(info['hits'] + info['misses'], 6005)
+
+    def test_cache_bounded(self):
+        set_result_cache(5)
+        dates = [date(2014, 1, 1) + timedelta(days=i) for i in range(100)]
+        self.assertEqual(date_fromisoformat_many([d.isoformat() for d in dates]), dates)
+        self.assertEqual(get_result_cache_info()['currsize'], 5)
+
+        set_result_cache(0)
+        self.assertEqual(get_result_cache_info(),
+                         {'hits': 0, 'misses': 0, 'maxsize': 0, 'currsize': 0, 'datetimes': False})
+
+    def test_cache_datetimes(self):
+        set_result_cache(16, datetimes=True)
+        dt = datetime_fromisoformat('2014-02-05T23:45+00:00')
+        self.assertIs(datetime_fromisoformat('2014-02-05T23:45+00:00'), dt)
+        self.assertIsNot(date_fromisoformat('2014-02-05'), datetime_fromisoformat('2014-02-05'))
+
+        # Changing the timezone mode drops cached datetimes
+        self.addCleanup(set_timezone_mode, get_timezone_mode())
+        set_timezone_mode('utc')
+        self.assertIs(datetime_fromisoformat('2014-02-05T23:45+00:00').tzinfo, timezone.utc)
+
+    def test_cache_fails(self):
+        with self.assertRaises(ValueError):
+            set_result_cache(-1)
+        with self.assertRaises(TypeError):
+            set_result_cache(16, True)
+
+
+_int_p = ctypes.POINTER(ctypes.c_int)
+
+
+class DatetimeFromIsoformatCAPI(ctypes.Structure):
+    _fields_ = [
+        ('version', ctypes.c_int),
+        ('parse_date', ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_char_p, ctypes.c_ssize_t, *[_int_p] * 3)),
+        ('parse_time', ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_char_p, ctypes.c_ssize_t, *[_int_p] * 6)),
+        ('parse_datetime', ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_char_p, ctypes.c_ssize_t, *[_int_p] * 9)),
+        ('new_fixed_offset', ctypes.PYFUNCTYPE(ctypes.py_object, ctypes.c_int)),
+        ('new_tzinfo', ctypes.PYFUNCTYPE(ctypes.py_object, ctypes.c_int)),
+    ]
+
+
+class TestCAPI(unittest.TestCase):
+    def setUp(self):
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+        pointer = get_pointer(backports._datetime_fromisoformat._C_API, b'backports._datetime_fromisoformat._C_API')
+        self.api = ctypes.cast(pointer, ctypes.POINTER(DatetimeFromIsoformatCAPI)).contents
+
+    def call(self, func, s, count):
+        fields = [ctypes.c_int() for _ in range(count)]
+        rv = func(s, len(s), *[ctypes.byref(field) for field in fields])
+        return rv, [field.value for field in fields] if rv >= 0 else None
+
+    def test_capi(self):
+        self.assertEqual(self.api.version, 1)
+        self.assertTrue(os.path.exists(os.path.join(get_include(), 'datetime_fromisoformat_api.h')))
+
+        self.assertEqual(self.call(self.api.parse_date, b'2025-W01-4', 3), (0, [2025, 1, 2]))
+        self.assertEqual(self.call(self.api.parse_date, b'2014-02-30', 3), (-1, None))
+        self.assertEqual(self.call(self.api.parse_time, b'23:45:12.5', 6), (0, [23, 45, 12, 500000, 0, 0]))
+        self.assertEqual(self.call(self.api.parse_time, b'12:00+24:00', 6), (-1, None))
+        self.assertEqual(self.call(self.api.parse_datetime, b'2014-02-05\xc3\xa923:45-05:30', 9),
+                         (1, [2014, 2, 5, 23, 45, 0, 0, -19800, 0]))
+        self.assertEqual(self.call(self.api.parse_datetime, b'2014-02-05T24:45', 9), (-1, None))
+
+    def test_capi_tzinfo(self):
+        self.assertIs(self.api.new_fixed_offset(-19800), FixedOffset(-19800))
+        self.assertEqual(self.api.new_tzinfo(3600).utcoffset(None), timedelta(hours=1))
+        for func in [self.api.new_fixed_offset, self.api.new_tzinfo]:
+            for offset in [86400, -86400, 2**31 - 1, -2**31]:
+                with self.subTest(func=func, offset=offset):
+                    with self.assertRaises(ValueError):
+                        func(offset)
+
+
 if __name__ == '__main__':
     unittest.main()